@@ -7,11 +7,20 @@ SET(CHECK_FILES
     ${PROJECT_SOURCE_DIR}/lib/Gfx/*.c
     ${PROJECT_SOURCE_DIR}/lib/AsyncIO/include/*.h
     ${PROJECT_SOURCE_DIR}/lib/AsyncIO/*.c
+    ${PROJECT_SOURCE_DIR}/lib/TraceBuffer/include/*.h
+    ${PROJECT_SOURCE_DIR}/lib/TraceBuffer/*.c
+    ${PROJECT_SOURCE_DIR}/lib/TasksetFile/include/*.h
+    ${PROJECT_SOURCE_DIR}/lib/TasksetFile/*.c
+    ${PROJECT_SOURCE_DIR}/lib/ResultSink/include/*.h
+    ${PROJECT_SOURCE_DIR}/lib/ResultSink/*.c
     ${PROJECT_SOURCE_DIR}/src/*.c)
 
 SET(TIDY_SOURCES
     ${PROJECT_SOURCE_DIR}/lib/Gfx
     ${PROJECT_SOURCE_DIR}/lib/AsyncIO
+    ${PROJECT_SOURCE_DIR}/lib/TraceBuffer
+    ${PROJECT_SOURCE_DIR}/lib/TasksetFile
+    ${PROJECT_SOURCE_DIR}/lib/ResultSink
     ${PROJECT_SOURCE_DIR}/src
     )
 
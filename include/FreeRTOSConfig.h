@@ -70,7 +70,8 @@
 #define configUSE_IDLE_HOOK             1
 #define configUSE_TICK_HOOK             0
 #define configTICK_RATE_HZ              ( ( TickType_t ) 1000 )
-#define configMINIMAL_STACK_SIZE        ( ( unsigned short ) 4 ) /* This can be made smaller if required. */
+#define configMINIMAL_STACK_SIZE        ( ( unsigned short ) 8192 ) /* The Ucontext port runs the tasks on these stacks, the Posix port does not use them. */
+#define configTHREAD_STACK_SIZE         ( 64 * 1024 ) /* Bytes of the thread stack of every task in the Posix port. */
 #define configTOTAL_HEAP_SIZE           ( ( size_t ) ( 32 * 1024 ) )
 #define configMAX_TASK_NAME_LEN         ( 16 )
 #define configUSE_TRACE_FACILITY        1
@@ -89,6 +90,41 @@
 #define configQUEUE_REGISTRY_SIZE       0
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY    1
 
+/* Ordering of the delayed task lists, see listORDER_XXX in list.h: 0 keeps the
+ sorted linked list, 1 uses a binary min-heap, 2 a hierarchical timing wheel,
+ 3 per period buckets, 4 a skip list.  With configUSE_DELAYED_LIST_ORDER_SELECTION
+ set to 1 the orderings other than the wheel can also be chosen at run time.
+ configUSE_SKIP_LISTS set to 1 turns every sorted list, the event lists of the
+ queues included, into a skip list. */
+#define configDELAYED_LIST_ORDER        0
+#define configUSE_DELAYED_LIST_ORDER_SELECTION  0
+#define configUSE_SKIP_LISTS            0
+
+/* With configUSE_VIRTUAL_TIME set to 1 the Posix and Ucontext ports do not
+ tick in real time.  Whenever all tasks are blocked the tick count jumps to the
+ next time a task unblocks, so a simulation runs as fast as the tasks can be
+ executed.  Ports that tick from the idle task, set portTICK_FROM_IDLE, need
+ the tickless idle mode. */
+#define configUSE_VIRTUAL_TIME          0
+#define configUSE_TICKLESS_IDLE         portTICK_FROM_IDLE
+
+/* With configUSE_FUTEX_HANDOFF set to 1 the Posix port switches between the
+ task threads by handing the processor over through a futex per thread, which
+ is much faster than the default suspend and resume signals. */
+#define configUSE_FUTEX_HANDOFF         0
+
+/* With configUSE_TICK_THREAD set to 1 the Posix port ticks from a thread that
+ waits on a timerfd instead of ITIMER_REAL.  It counts every expiration, also
+ the ones it was late for, and the tick handler processes all ticks counted
+ since it ran last, so merged or blocked SIG_TICK signals no longer drop ticks.
+ This allows configTICK_RATE_HZ up to 100000. */
+#define configUSE_TICK_THREAD           0
+
+/* With configUSE_SLAB_HEAP set to 1 pvPortMalloc() serves TCBs, queues, timers
+ and other small blocks from lock-free size class pools (heap_slab.c) instead
+ of taking the scheduler lock around malloc() (heap_3.c). */
+#define configUSE_SLAB_HEAP             1
+
 #define configMAX_PRIORITIES        ( 10 )
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
 
@@ -312,6 +312,10 @@ extern "C" {
 #define portPRE_TASK_DELETE_HOOK( pvTaskToDelete, pxYieldPending )
 #endif
 
+#ifndef portHEAP_RESET_ALLOWED
+#define portHEAP_RESET_ALLOWED() pdTRUE
+#endif
+
 #ifndef portSETUP_TCB
 #define portSETUP_TCB( pxTCB ) ( void ) pxTCB
 #endif
@@ -696,18 +700,56 @@ task that attempted the write. */
 #define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )
 #endif
 
+#ifndef configUSE_VIRTUAL_TIME
+#define configUSE_VIRTUAL_TIME 0
+#endif
+
+#ifndef configUSE_TICK_THREAD
+#define configUSE_TICK_THREAD 0
+#endif
+
+#ifndef configUSE_SLAB_HEAP
+#define configUSE_SLAB_HEAP 0
+#endif
+
+#ifndef portTASK_STACK_DEPTH
+/* Number of words of the stack xTaskCreate() allocates for a task that asked
+for usStackDepth words.  Ports that run the tasks on stacks of their own need
+less, or none at all. */
+#define portTASK_STACK_DEPTH( usStackDepth ) ( usStackDepth )
+#endif
+
+#ifndef portTICK_FROM_IDLE
+/* Set to 1 by ports that generate the ticks from portSUPPRESS_TICKS_AND_SLEEP()
+rather than from a timer interrupt. */
+#define portTICK_FROM_IDLE 0
+#endif
+
 #ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+#if( portTICK_FROM_IDLE == 1 )
+/* The tick has to be advanced even if a task unblocks on the next tick. */
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 1
+#else
 #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
 #endif
+#endif
 
-#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2
+#if( ( configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2 ) && ( portTICK_FROM_IDLE == 0 ) )
 #error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
 #endif
 
+#if( ( configEXPECTED_IDLE_TIME_BEFORE_SLEEP != 1 ) && ( portTICK_FROM_IDLE == 1 ) )
+#error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must be 1 if the port ticks from the idle task
+#endif
+
 #ifndef configUSE_TICKLESS_IDLE
 #define configUSE_TICKLESS_IDLE 0
 #endif
 
+#if( ( portTICK_FROM_IDLE == 1 ) && ( configUSE_TICKLESS_IDLE == 0 ) )
+#error configUSE_TICKLESS_IDLE must not be 0 if the port ticks from the idle task
+#endif
+
 #ifndef configPRE_SLEEP_PROCESSING
 #define configPRE_SLEEP_PROCESSING( x )
 #endif
@@ -728,6 +770,19 @@ task that attempted the write. */
 #define configUSE_TIME_SLICING 1
 #endif
 
+#ifndef configDELAYED_LIST_ORDER
+/* Defaults to the sorted linked list, see listORDER_SORTED_LIST in list.h. */
+#define configDELAYED_LIST_ORDER 0
+#endif
+
+#ifndef configUSE_DELAYED_LIST_ORDER_SELECTION
+#define configUSE_DELAYED_LIST_ORDER_SELECTION 0
+#endif
+
+#ifndef configUSE_SKIP_LISTS
+#define configUSE_SKIP_LISTS 0
+#endif
+
 #ifndef configINCLUDE_APPLICATION_DEFINED_PRIVILEGED_FUNCTIONS
 #define configINCLUDE_APPLICATION_DEFINED_PRIVILEGED_FUNCTIONS 0
 #endif
@@ -175,6 +175,95 @@ contain its expected value. */
 #endif /* configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES */
 
 
+/*
+ * Orderings that vListInsert() can keep a list in.  Ordinary lists are always
+ * sorted linked lists, the lists the scheduler holds delayed tasks in use the
+ * ordering selected by configDELAYED_LIST_ORDER in FreeRTOSConfig.h.
+ *
+ * listORDER_SORTED_LIST: the standard FreeRTOS list.  vListInsert() walks the
+ * list to find the insertion point, which is O(n).
+ *
+ * listORDER_BINARY_HEAP: an intrusive binary min-heap keyed on xItemValue,
+ * giving O(log n) insertion and removal.  The items are still linked into the
+ * list so it can be walked and counted as usual, but only the head entry is
+ * in order - it is always the item with the lowest value, so
+ * listGET_OWNER_OF_HEAD_ENTRY() keeps working in O(1).
+ *
+ * listORDER_TIMING_WHEEL: a hierarchical timing wheel for item values that
+ * are tick counts.  Items are hashed into slots by their distance from the
+ * time the wheel has been advanced to, so insertion and removal are O(1) and
+ * values are compared modulo the tick range, an overflow of the tick count
+ * needs no special handling.  The list is not sorted at all, due items are
+ * obtained with pvListWheelGetDueOwner() instead of from the head of the list.
+ * The wheel storage is attached with vListInitialiseWheel().
+ *
+ * listORDER_PERIOD_BUCKETS: bucketed ordered insertion.  Items carry a bucket
+ * key, set with listSET_LIST_ITEM_BUCKET_KEY(), and items with equal keys are
+ * queued first in first out in a bucket of their own.  When items with the
+ * same key are inserted in increasing value order, as the delay of a task that
+ * always blocks for the same number of ticks is, insertion is an append to the
+ * tail of the bucket.  Only the buckets are kept sorted, by the value of their
+ * first item, so the cost depends on the number of distinct keys rather than
+ * on the number of items.  As with the heap the head entry of the list is
+ * always the item with the lowest value.  The bucket storage is attached with
+ * vListInitialiseBuckets().
+ *
+ * listORDER_SKIP_LIST: a skip list on top of the sorted list.  The list itself
+ * stays fully sorted, so this can stand in for listORDER_SORTED_LIST on any
+ * list, and each item is also linked into a random number of express lanes
+ * (each lane holding a quarter of the items of the one below), which gives an
+ * expected O(log n) insertion.  An item unlinks itself from its lanes, so
+ * removal stays O(1).  Setting configUSE_SKIP_LISTS to 1 in FreeRTOSConfig.h
+ * makes this the ordering of every list, the event lists included.
+ */
+#define listORDER_SORTED_LIST       0
+#define listORDER_BINARY_HEAP       1
+#define listORDER_TIMING_WHEEL      2
+#define listORDER_PERIOD_BUCKETS    3
+#define listORDER_SKIP_LIST         4
+
+/* The alternative orderings are only compiled in when a list can use one of
+them, or when the ordering can be selected at run time. */
+#if( ( configDELAYED_LIST_ORDER != listORDER_SORTED_LIST ) || ( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 ) || ( configUSE_SKIP_LISTS == 1 ) )
+#define listUSE_ORDERS  1
+#else
+#define listUSE_ORDERS  0
+#endif
+
+/* The express lanes of a skip list take two pointers per lane in every list
+item, so they are only added when a skip list can be used. */
+#if( ( configDELAYED_LIST_ORDER == listORDER_SKIP_LIST ) || ( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 ) || ( configUSE_SKIP_LISTS == 1 ) )
+#define listUSE_SKIP_LISTS  1
+#else
+#define listUSE_SKIP_LISTS  0
+#endif
+
+/* Geometry of a timing wheel: each level has 64 slots (one bit of a 64 bit
+occupancy mask per slot) and covers six more bits of the tick count than the
+level below, with enough levels to span the whole TickType_t range. */
+#define listWHEEL_LEVEL_BITS    6
+#define listWHEEL_SLOTS         ( 1U << listWHEEL_LEVEL_BITS )
+#define listWHEEL_LEVELS        ( ( ( sizeof( TickType_t ) * 8U ) + listWHEEL_LEVEL_BITS - 1U ) / listWHEEL_LEVEL_BITS )
+
+/* Number of buckets a listORDER_PERIOD_BUCKETS list can use, and the number of
+hash chains they are looked up by key through (a power of two).  Once all the
+buckets are in use further keys share an existing bucket, which remains
+correct but loses the constant time append. */
+#ifndef listBUCKET_COUNT
+#define listBUCKET_COUNT        256
+#endif
+
+#ifndef listBUCKET_HASH_SIZE
+#define listBUCKET_HASH_SIZE    64
+#endif
+
+/* Number of express lanes of a skip list.  With a quarter of the items going
+up each lane, eight lanes keep the insertion logarithmic up to about 64k
+items. */
+#ifndef listSKIP_LEVELS
+#define listSKIP_LEVELS         8
+#endif
+
 /*
  * Definition of the only type of object that a list can contain.
  */
@@ -185,6 +274,17 @@ struct xLIST_ITEM {
     struct xLIST_ITEM *configLIST_VOLATILE pxPrevious;  /*< Pointer to the previous ListItem_t in the list. */
     void *pvOwner;                                      /*< Pointer to the object (normally a TCB) that contains the list item.  There is therefore a two way link between the object containing the list item and the list item itself. */
     void *configLIST_VOLATILE pvContainer;              /*< Pointer to the list in which this list item is placed (if any). */
+#if( listUSE_ORDERS == 1 )
+    struct xLIST_ITEM *configLIST_VOLATILE pxOrderParent;    /*< listORDER_BINARY_HEAP: parent of the item.  listORDER_TIMING_WHEEL and listORDER_PERIOD_BUCKETS: the slot or bucket the item is queued in. */
+    struct xLIST_ITEM *configLIST_VOLATILE pxOrderLeft;      /*< listORDER_BINARY_HEAP: left child.  Otherwise the previous item in the slot or bucket. */
+    struct xLIST_ITEM *configLIST_VOLATILE pxOrderRight;     /*< listORDER_BINARY_HEAP: right child.  Otherwise the next item in the slot or bucket. */
+    TickType_t xBucketKey;                                   /*< listORDER_PERIOD_BUCKETS: items with the same key share a bucket. */
+#if( listUSE_SKIP_LISTS == 1 )
+    UBaseType_t uxSkipLevels;                                /*< listORDER_SKIP_LIST: number of express lanes the item is linked into. */
+    struct xLIST_ITEM *pxSkipNext[ listSKIP_LEVELS ];        /*< listORDER_SKIP_LIST: next item in each lane, NULL at the end of the lane. */
+    struct xLIST_ITEM *pxSkipPrevious[ listSKIP_LEVELS ];    /*< listORDER_SKIP_LIST: previous item in each lane, NULL at the start of the lane. */
+#endif
+#endif
     listSECOND_LIST_ITEM_INTEGRITY_CHECK_VALUE          /*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
 };
 typedef struct xLIST_ITEM ListItem_t;                   /* For some reason lint wants this as two separate definitions. */
@@ -197,6 +297,45 @@ struct xMINI_LIST_ITEM {
 };
 typedef struct xMINI_LIST_ITEM MiniListItem_t;
 
+#if( listUSE_ORDERS == 1 )
+
+/*
+ * Storage for a listORDER_TIMING_WHEEL list.  Each slot is the head of a
+ * circular list linked through the pxOrderLeft and pxOrderRight members of the
+ * items queued in it.
+ */
+typedef struct xLIST_WHEEL {
+    TickType_t xTime;                                   /*< The tick the wheel has been advanced to, items in the level 0 slot of this tick are due. */
+    uint64_t ullOccupied[ listWHEEL_LEVELS ];           /*< One bit per non-empty slot of each level. */
+    ListItem_t xSlots[ listWHEEL_LEVELS ][ listWHEEL_SLOTS ];
+} ListWheel_t;
+
+/*
+ * A bucket of a listORDER_PERIOD_BUCKETS list.  xItems is the head of the
+ * circular list of the queued items, linked through their pxOrderLeft and
+ * pxOrderRight members, and must be the first member so the pxOrderParent
+ * pointer of an item can be cast back to its bucket.
+ */
+typedef struct xLIST_BUCKET {
+    ListItem_t xItems;                                  /*< xItems.pxOrderRight is the first (lowest valued) item, xItems.pxOrderLeft the last. */
+    TickType_t xKey;
+    struct xLIST_BUCKET *pxNext;                        /*< Next bucket in order of the value of the first item. */
+    struct xLIST_BUCKET *pxPrevious;
+    struct xLIST_BUCKET *pxNextInChain;                 /*< Next bucket in the same hash chain, or in the free list. */
+} ListBucket_t;
+
+/*
+ * Storage for a listORDER_PERIOD_BUCKETS list.
+ */
+typedef struct xLIST_BUCKETS {
+    ListBucket_t *pxFirst;                              /*< The bucket holding the item with the lowest value. */
+    ListBucket_t *pxFree;
+    ListBucket_t *pxChains[ listBUCKET_HASH_SIZE ];
+    ListBucket_t xBuckets[ listBUCKET_COUNT ];
+} ListBuckets_t;
+
+#endif /* listUSE_ORDERS */
+
 /*
  * Definition of the type of queue used by the scheduler.
  */
@@ -205,9 +344,31 @@ typedef struct xLIST {
     configLIST_VOLATILE UBaseType_t uxNumberOfItems;
     ListItem_t *configLIST_VOLATILE pxIndex;            /*< Used to walk through the list.  Points to the last item returned by a call to listGET_OWNER_OF_NEXT_ENTRY (). */
     MiniListItem_t xListEnd;                            /*< List item that contains the maximum possible item value meaning it is always at the end of the list and is therefore used as a marker. */
+#if( listUSE_ORDERS == 1 )
+    UBaseType_t uxOrder;                                /*< One of the listORDER_xxx values, set by vListSetOrder(). */
+    ListItem_t *configLIST_VOLATILE pxHeapRoot;         /*< Root of the heap if uxOrder is listORDER_BINARY_HEAP. */
+    ListWheel_t *pxWheel;                               /*< Wheel storage if uxOrder is listORDER_TIMING_WHEEL. */
+    ListBuckets_t *pxBuckets;                           /*< Bucket storage if uxOrder is listORDER_PERIOD_BUCKETS. */
+#if( listUSE_SKIP_LISTS == 1 )
+    ListItem_t *pxSkipHead[ listSKIP_LEVELS ];          /*< First item of each express lane if uxOrder is listORDER_SKIP_LIST. */
+#endif
+#endif
     listSECOND_LIST_INTEGRITY_CHECK_VALUE               /*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
 } List_t;
 
+/*
+ * Memory and ordering statistics of a list, filled in by vListGetStats().
+ */
+typedef struct xLIST_STATS {
+    UBaseType_t uxOrder;                                /*< One of the listORDER_xxx values. */
+    UBaseType_t uxNumberOfItems;
+    size_t xItemSize;                                   /*< sizeof( ListItem_t ). */
+    size_t xItemOrderSize;                              /*< Bytes of every ListItem_t taken by the members of the alternative orderings. */
+    size_t xListSize;                                   /*< sizeof( List_t ). */
+    size_t xStorageSize;                                /*< Bytes of wheel or bucket storage attached to the list. */
+    UBaseType_t uxSkipLinks;                            /*< Express lane links in use by the items of a skip list. */
+} ListStats_t;
+
 /*
  * Access macro to set the owner of a list item.  The owner of a list item
  * is the object (usually a TCB) that contains the list item.
@@ -235,6 +396,21 @@ typedef struct xLIST {
  */
 #define listSET_LIST_ITEM_VALUE( pxListItem, xValue )   ( ( pxListItem )->xItemValue = ( xValue ) )
 
+/*
+ * Access macro to set the bucket key of the list item, which selects the
+ * bucket the item is queued in when it is inserted into a
+ * listORDER_PERIOD_BUCKETS list.  Has no effect when the alternative list
+ * orderings are not compiled in.
+ *
+ * \page listSET_LIST_ITEM_BUCKET_KEY listSET_LIST_ITEM_BUCKET_KEY
+ * \ingroup LinkedList
+ */
+#if( listUSE_ORDERS == 1 )
+#define listSET_LIST_ITEM_BUCKET_KEY( pxListItem, xKey )    ( ( pxListItem )->xBucketKey = ( xKey ) )
+#else
+#define listSET_LIST_ITEM_BUCKET_KEY( pxListItem, xKey )
+#endif
+
 /*
  * Access macro to retrieve the value of the list item.  The value can
  * represent anything - for example the priority of a task, or the time at
@@ -382,6 +558,104 @@ typedef struct xLIST {
  */
 void vListInitialise(List_t *const pxList) PRIVILEGED_FUNCTION;
 
+#if( listUSE_ORDERS == 1 )
+
+/*
+ * Select the ordering vListInsert() maintains for a list, one of the
+ * listORDER_xxx values.  vListInitialise() sets listORDER_SORTED_LIST, the
+ * ordering may only be changed while the list is empty.
+ *
+ * @param pxList Pointer to the list being configured.
+ *
+ * @param uxOrder The ordering to use from now on.
+ *
+ * \page vListSetOrder vListSetOrder
+ * \ingroup LinkedList
+ */
+void vListSetOrder(List_t *const pxList, UBaseType_t uxOrder) PRIVILEGED_FUNCTION;
+
+/*
+ * Turn an empty list into a listORDER_TIMING_WHEEL list that keeps its items
+ * in pxWheel.  The list must have been initialised with vListInitialise().
+ *
+ * @param pxList Pointer to the list being configured.
+ *
+ * @param pxWheel Storage for the wheel, used for as long as the list is.
+ *
+ * @param xTime The current tick count, the wheel starts at this time.
+ *
+ * \page vListInitialiseWheel vListInitialiseWheel
+ * \ingroup LinkedList
+ */
+void vListInitialiseWheel(List_t *const pxList, ListWheel_t *const pxWheel, TickType_t xTime) PRIVILEGED_FUNCTION;
+
+/*
+ * Advance a listORDER_TIMING_WHEEL list up to xTime and return the owner of
+ * one of the items that are due by then, or NULL if none is.  The item stays
+ * in the list, so the caller removes it with uxListRemove() and calls again
+ * until NULL is returned.  xTime must not be behind the time of a previous
+ * call.
+ *
+ * @param pxList The wheel list.
+ *
+ * @param xTime The current tick count.
+ *
+ * @return The pvOwner of a due item, or NULL.
+ *
+ * \page pvListWheelGetDueOwner pvListWheelGetDueOwner
+ * \ingroup LinkedList
+ */
+void *pvListWheelGetDueOwner(List_t *const pxList, TickType_t xTime) PRIVILEGED_FUNCTION;
+
+/*
+ * Return a lower bound on the number of ticks from xTime until an item of a
+ * listORDER_TIMING_WHEEL list falls due, found from the occupancy masks
+ * without looking at the items.  Items held on an upper level of the wheel
+ * are reported at the tick their slot is cascaded, which can be earlier than
+ * their own value.
+ *
+ * @param pxList The wheel list.
+ *
+ * @param xTime The current tick count.
+ *
+ * @return The number of ticks, or portMAX_DELAY if the list is empty.
+ *
+ * \page xListWheelTicksUntilDue xListWheelTicksUntilDue
+ * \ingroup LinkedList
+ */
+TickType_t xListWheelTicksUntilDue(List_t *const pxList, TickType_t xTime) PRIVILEGED_FUNCTION;
+
+/*
+ * Turn an empty list into a listORDER_PERIOD_BUCKETS list that keeps its
+ * buckets in pxBuckets.  The list must have been initialised with
+ * vListInitialise().
+ *
+ * @param pxList Pointer to the list being configured.
+ *
+ * @param pxBuckets Storage for the buckets, used for as long as the list is.
+ *
+ * \page vListInitialiseBuckets vListInitialiseBuckets
+ * \ingroup LinkedList
+ */
+void vListInitialiseBuckets(List_t *const pxList, ListBuckets_t *const pxBuckets) PRIVILEGED_FUNCTION;
+
+#endif /* listUSE_ORDERS */
+
+/*
+ * Report the memory the ordering of a list costs, so the RAM taken by the
+ * alternative orderings can be weighed against their insertion time.  The
+ * items of the list are walked, so this should not be called with the list
+ * being modified.
+ *
+ * @param pxList The list to report on.
+ *
+ * @param pxStats Filled in with the statistics of the list.
+ *
+ * \page vListGetStats vListGetStats
+ * \ingroup LinkedList
+ */
+void vListGetStats(const List_t *const pxList, ListStats_t *const pxStats) PRIVILEGED_FUNCTION;
+
 /*
  * Must be called before a list item is used.  This sets the list container to
  * null so the item does not think that it is already contained in a list.
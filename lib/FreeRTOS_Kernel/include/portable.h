@@ -173,6 +173,34 @@ void vPortInitialiseBlocks(void) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize(void) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize(void) PRIVILEGED_FUNCTION;
 
+/* Used by heap_slab.c, one per size class. */
+typedef struct SlabStats {
+    size_t xBlockSize;          /* 0 for the blocks that came from malloc(). */
+    size_t xBlocksCarved;       /* Blocks of the class handed out since the last reset. */
+    size_t xBlocksInUse;
+    uint64_t ullAllocations;
+    uint64_t ullRequestedBytes; /* Against ullAllocations * xBlockSize gives the internal fragmentation. */
+    uint64_t ullOverflows;      /* Allocations passed on to malloc() as the class was used up. */
+} SlabStats_t;
+
+/*
+ * Fills in at most uxMaxClasses entries of pxStats, the size classes of
+ * heap_slab.c in ascending order followed by the malloc() blocks, and returns
+ * the number of entries.  Blocks that were carved but are not in use wait on
+ * the free list of their class.  The counts start over when the heap is reset
+ * with xPortResetHeap().
+ */
+UBaseType_t uxPortGetSlabStats(SlabStats_t *pxStats, UBaseType_t uxMaxClasses) PRIVILEGED_FUNCTION;
+
+/*
+ * Drops every block heap_slab.c has handed out at once, in time independent of
+ * the number of blocks, and returns pdTRUE.  Returns pdFALSE and drops nothing
+ * if blocks that came from malloc() are still in use, they have to be freed
+ * with vPortFree().  Nothing may use a block of the heap or allocate from it
+ * at the same time.  Used by vTaskResetKernel().
+ */
+BaseType_t xPortResetHeap(void) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -1160,6 +1160,47 @@ void vTaskStartScheduler(void) PRIVILEGED_FUNCTION;
  */
 void vTaskEndScheduler(void) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <pre>void vTaskResetKernel( void );</pre>
+ *
+ * Frees every task that is left once vTaskStartScheduler() has returned after
+ * a call to vTaskEndScheduler(), and puts the kernel back into the state it
+ * had before the first task was created.  Tasks can then be created and the
+ * scheduler started again, so several simulations can run one after the other
+ * in the same process.
+ *
+ * The port must have ended the threads or contexts of all tasks before
+ * vTaskStartScheduler() returns.  INCLUDE_vTaskDelete must be set to 1.
+ *
+ * With configUSE_SLAB_HEAP set to 1 the whole heap is the arena of the run and
+ * dropped at once, in time independent of the number of tasks, which also
+ * frees the queues, semaphores and timers created by the application.  Their
+ * handles must not be used any more.  Otherwise only the tasks are freed, one
+ * by one.
+ *
+ * Example usage:
+   <pre>
+ void vAFunction( void )
+ {
+     for( ;; )
+     {
+         xTaskCreate( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL );
+
+         // Returns when vTaskCode () calls vTaskEndScheduler ().
+         vTaskStartScheduler ();
+
+         // Free the tasks before the next run.
+         vTaskResetKernel ();
+     }
+ }
+   </pre>
+ *
+ * \defgroup vTaskResetKernel vTaskResetKernel
+ * \ingroup SchedulerControl
+ */
+void vTaskResetKernel(void) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <pre>void vTaskSuspendAll( void );</pre>
@@ -1296,6 +1337,41 @@ TickType_t xTaskGetTickCount(void) PRIVILEGED_FUNCTION;
  */
 TickType_t xTaskGetTickCountFromISR(void) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>BaseType_t xTaskSetDelayedListOrder( UBaseType_t uxOrder );</PRE>
+ *
+ * configUSE_DELAYED_LIST_ORDER_SELECTION must be defined as 1 for this
+ * function to be available.
+ *
+ * Select the ordering of the lists that hold delayed tasks, overriding
+ * configDELAYED_LIST_ORDER.  All orderings but listORDER_TIMING_WHEEL can be
+ * selected at run time, and only before the scheduler is started.
+ *
+ * @param uxOrder One of the listORDER_xxx values defined in list.h.
+ *
+ * @return pdPASS if the ordering was selected, pdFAIL if the ordering is not
+ * available or the scheduler is already running.
+ *
+ * \defgroup xTaskSetDelayedListOrder xTaskSetDelayedListOrder
+ * \ingroup TaskUtils
+ */
+BaseType_t xTaskSetDelayedListOrder(UBaseType_t uxOrder) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>void vTaskGetDelayedListStats( ListStats_t *pxStats );</PRE>
+ *
+ * Obtain the memory and ordering statistics of the list that currently holds
+ * the delayed tasks, see vListGetStats() in list.h.
+ *
+ * @param pxStats Filled in with the statistics of the delayed list.
+ *
+ * \defgroup vTaskGetDelayedListStats vTaskGetDelayedListStats
+ * \ingroup TaskUtils
+ */
+void vTaskGetDelayedListStats(ListStats_t *const pxStats) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <PRE>uint16_t uxTaskGetNumberOfTasks( void );</PRE>
@@ -2229,6 +2305,16 @@ void vTaskSetTaskNumber(TaskHandle_t xTask, const UBaseType_t uxHandle) PRIVILEG
  */
 void vTaskStepTick(const TickType_t xTicksToJump) PRIVILEGED_FUNCTION;
 
+/*
+ * Processes ticks that the port could not process when they occurred, eg.
+ * because the interrupts were disabled.  They are added to the pended ticks
+ * and processed by xTaskResumeAll() like ticks that occurred while the
+ * scheduler was suspended, so delayed tasks unblock at the tick they were due.
+ * Must be called by a task, with the scheduler running and not suspended.
+ * Returns pdTRUE if a task was switched to.
+ */
+BaseType_t xTaskCatchUpTicks(TickType_t xTicksToCatchUp) PRIVILEGED_FUNCTION;
+
 /*
  * Only avilable when configUSE_TICKLESS_IDLE is set to 1.
  * Provided for use within portSUPPRESS_TICKS_AND_SLEEP() to allow the port
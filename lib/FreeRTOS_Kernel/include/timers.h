@@ -1304,6 +1304,7 @@ TickType_t xTimerGetExpiryTime(TimerHandle_t xTimer) PRIVILEGED_FUNCTION;
  */
 BaseType_t xTimerCreateTimerTask(void) PRIVILEGED_FUNCTION;
 BaseType_t xTimerGenericCommand(TimerHandle_t xTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue, BaseType_t *const pxHigherPriorityTaskWoken, const TickType_t xTicksToWait) PRIVILEGED_FUNCTION;
+void vTimerResetState(void) PRIVILEGED_FUNCTION;
 
 #ifdef __cplusplus
 }
@@ -71,6 +71,14 @@
 #define TRACE_TIMING
 #define TRACE_LABEL "TIME"
 
+/* uncomment to record the insertion times into the binary trace buffer
+instead of printing each one, see TRACE_BUFFER in main.c */
+// #define TRACE_BUFFER
+
+/* uncomment to also count the insertion times into a histogram per list,
+see TRACE_HISTOGRAM in main.c */
+// #define TRACE_HISTOGRAM
+
 #include <stdlib.h>
 #include "FreeRTOS.h"
 #include "list.h"
@@ -82,6 +90,92 @@
 #include <unistd.h>
 #include <sys/time.h>
 
+#ifdef TRACE_TIMING
+#include "TraceClock.h"
+#endif
+
+#if defined( TRACE_TIMING ) && defined( TRACE_BUFFER )
+#include "TraceBuffer.h"
+#endif
+
+#if defined( TRACE_TIMING ) && defined( TRACE_HISTOGRAM )
+#include "TraceHistogram.h"
+#endif
+
+#ifndef listCOUNT_TRAILING_ZEROS
+/* Index of the lowest set bit of a non-zero 64 bit mask. */
+#define listCOUNT_TRAILING_ZEROS( ullBits )     ( ( UBaseType_t ) __builtin_ctzll( ullBits ) )
+#endif
+
+/*
+ * Insert an item into a list kept in listORDER_SORTED_LIST order.
+ */
+static void prvInsertSorted(List_t *const pxList, ListItem_t *const pxNewListItem);
+
+#if( listUSE_ORDERS == 1 )
+
+/*
+ * Binary heap helpers for lists kept in listORDER_BINARY_HEAP order.  The heap
+ * is a complete binary tree linked through the pxOrderParent, pxOrderLeft and
+ * pxOrderRight members of the items, the position of a node is found from the
+ * binary representation of its index so no array has to be allocated.
+ */
+static ListItem_t *prvHeapItemAt(const List_t *const pxList, UBaseType_t uxPosition);
+static void prvHeapSwapWithParent(List_t *const pxList, ListItem_t *const pxChild);
+static void prvHeapSiftUp(List_t *const pxList, ListItem_t *const pxItem);
+static void prvHeapSiftDown(List_t *const pxList, ListItem_t *const pxItem);
+static void prvHeapInsert(List_t *const pxList, ListItem_t *const pxNewListItem);
+static void prvHeapRemove(List_t *const pxList, ListItem_t *const pxItemToRemove);
+
+/*
+ * Timing wheel helpers for lists kept in listORDER_TIMING_WHEEL order.  The
+ * items are appended to the list itself, so it can be walked and counted, and
+ * are queued in the wheel slot that matches their distance from the time the
+ * wheel has been advanced to.  Slots of the upper levels are cascaded down
+ * whenever the level below wraps.
+ */
+static void prvWheelLink(ListWheel_t *const pxWheel, ListItem_t *const pxItem);
+static void prvWheelUnlink(ListWheel_t *const pxWheel, ListItem_t *const pxItem);
+static void prvWheelCascade(ListWheel_t *const pxWheel);
+
+/*
+ * Bucket helpers for lists kept in listORDER_PERIOD_BUCKETS order.  Items are
+ * queued in the bucket of their key, which is found through a small hash
+ * table, and the non-empty buckets are chained in order of their first item.
+ */
+static ListBucket_t *prvBucketFind(const ListBuckets_t *const pxBuckets, TickType_t xKey);
+static void prvBucketPlace(ListBuckets_t *const pxBuckets, ListBucket_t *const pxBucket, ListBucket_t *pxPrevious);
+static void prvBucketDetach(ListBuckets_t *const pxBuckets, ListBucket_t *const pxBucket);
+static void prvBucketInsert(List_t *const pxList, ListItem_t *const pxNewListItem);
+static void prvBucketRemove(List_t *const pxList, ListItem_t *const pxItemToRemove);
+
+/*
+ * Move an item of a heap or bucket ordered list to the head of the list, where
+ * the item with the lowest value is expected.
+ */
+static void prvMoveToHead(List_t *const pxList, ListItem_t *const pxItem);
+
+#endif /* listUSE_ORDERS */
+
+#if( listUSE_SKIP_LISTS == 1 )
+
+/*
+ * Skip list helpers for lists kept in listORDER_SKIP_LIST order.  The list
+ * itself is the bottom lane and stays sorted, the express lanes above it are
+ * NULL terminated lists linked through the pxSkipNext and pxSkipPrevious
+ * arrays of the items.
+ */
+static UBaseType_t prvSkipRandomLevels(void);
+static void prvSkipInsert(List_t *const pxList, ListItem_t *const pxNewListItem);
+static void prvSkipRemove(List_t *const pxList, ListItem_t *const pxItemToRemove);
+
+/* State of the generator that picks the number of lanes of a new item.  It
+is only used while a list is being modified, which the kernel does not do
+concurrently. */
+static uint32_t ulSkipRandom = 0x2545F491UL;
+
+#endif /* listUSE_SKIP_LISTS */
+
 /*-----------------------------------------------------------
  * PUBLIC LIST API documented in list.h
  *----------------------------------------------------------*/
@@ -104,6 +198,29 @@ void vListInitialise(List_t *const pxList)
 
     pxList->uxNumberOfItems = (UBaseType_t) 0U;
 
+#if( listUSE_ORDERS == 1 )
+    {
+#if( configUSE_SKIP_LISTS == 1 )
+        pxList->uxOrder = listORDER_SKIP_LIST;
+#else
+        pxList->uxOrder = listORDER_SORTED_LIST;
+#endif
+        pxList->pxHeapRoot = NULL;
+        pxList->pxWheel = NULL;
+        pxList->pxBuckets = NULL;
+    }
+#endif
+
+#if( listUSE_SKIP_LISTS == 1 )
+    {
+        UBaseType_t uxLevel;
+
+        for (uxLevel = 0; uxLevel < listSKIP_LEVELS; uxLevel++) {
+            pxList->pxSkipHead[ uxLevel ] = NULL;
+        }
+    }
+#endif
+
     /* Write known values into the list if
     configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
     listSET_LIST_INTEGRITY_CHECK_1_VALUE(pxList);
@@ -111,6 +228,189 @@ void vListInitialise(List_t *const pxList)
 }
 /*-----------------------------------------------------------*/
 
+#if( listUSE_ORDERS == 1 )
+
+void vListSetOrder(List_t *const pxList, UBaseType_t uxOrder)
+{
+    /* The items of a list cannot be reordered in place, and a timing wheel
+    needs storage - see vListInitialiseWheel(), as do buckets - see
+    vListInitialiseBuckets(). */
+    configASSERT(listLIST_IS_EMPTY(pxList) != pdFALSE);
+    configASSERT(uxOrder != listORDER_TIMING_WHEEL);
+    configASSERT(uxOrder != listORDER_PERIOD_BUCKETS);
+
+    pxList->uxOrder = uxOrder;
+    pxList->pxHeapRoot = NULL;
+    pxList->pxWheel = NULL;
+    pxList->pxBuckets = NULL;
+
+#if( listUSE_SKIP_LISTS == 1 )
+    {
+        UBaseType_t uxLevel;
+
+        for (uxLevel = 0; uxLevel < listSKIP_LEVELS; uxLevel++) {
+            pxList->pxSkipHead[ uxLevel ] = NULL;
+        }
+    }
+#endif
+}
+/*-----------------------------------------------------------*/
+
+void vListInitialiseWheel(List_t *const pxList, ListWheel_t *const pxWheel, TickType_t xTime)
+{
+    UBaseType_t uxLevel, uxSlot;
+    ListItem_t *pxSlot;
+
+    configASSERT(listLIST_IS_EMPTY(pxList) != pdFALSE);
+
+    pxWheel->xTime = xTime;
+
+    for (uxLevel = 0; uxLevel < listWHEEL_LEVELS; uxLevel++) {
+        pxWheel->ullOccupied[ uxLevel ] = 0ULL;
+
+        for (uxSlot = 0; uxSlot < listWHEEL_SLOTS; uxSlot++) {
+            /* An empty slot points back to itself. */
+            pxSlot = &(pxWheel->xSlots[ uxLevel ][ uxSlot ]);
+            pxSlot->pxOrderLeft = pxSlot;
+            pxSlot->pxOrderRight = pxSlot;
+            pxSlot->pxOrderParent = NULL;
+        }
+    }
+
+    pxList->uxOrder = listORDER_TIMING_WHEEL;
+    pxList->pxHeapRoot = NULL;
+    pxList->pxWheel = pxWheel;
+    pxList->pxBuckets = NULL;
+}
+/*-----------------------------------------------------------*/
+
+void *pvListWheelGetDueOwner(List_t *const pxList, TickType_t xTime)
+{
+    ListWheel_t *const pxWheel = pxList->pxWheel;
+    ListItem_t *pxSlot;
+    UBaseType_t uxLevel;
+    BaseType_t xEmpty;
+
+    for (;;) {
+        /* Everything queued in the level 0 slot of the current time is due. */
+        pxSlot = &(pxWheel->xSlots[ 0 ][ pxWheel->xTime & (listWHEEL_SLOTS - 1U) ]);
+        if (pxSlot->pxOrderRight != pxSlot) {
+            return pxSlot->pxOrderRight->pvOwner;
+        }
+
+        if (pxWheel->xTime == xTime) {
+            break;
+        }
+
+        /* An empty wheel can jump straight to the requested time. */
+        xEmpty = pdTRUE;
+        for (uxLevel = 0; uxLevel < listWHEEL_LEVELS; uxLevel++) {
+            if (pxWheel->ullOccupied[ uxLevel ] != 0ULL) {
+                xEmpty = pdFALSE;
+                break;
+            }
+        }
+
+        if (xEmpty != pdFALSE) {
+            pxWheel->xTime = xTime;
+        }
+        else {
+            pxWheel->xTime++;
+            prvWheelCascade(pxWheel);
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+TickType_t xListWheelTicksUntilDue(List_t *const pxList, TickType_t xTime)
+{
+    const ListWheel_t *const pxWheel = pxList->pxWheel;
+    const TickType_t xLag = xTime - pxWheel->xTime;
+    uint64_t ullBest = UINT64_MAX, ullTicks, ullRotated;
+    UBaseType_t uxLevel, uxShift, uxCurrent, uxOffset;
+
+    for (uxLevel = 0; uxLevel < listWHEEL_LEVELS; uxLevel++) {
+        if (pxWheel->ullOccupied[ uxLevel ] == 0ULL) {
+            continue;
+        }
+
+        /* Find the first occupied slot at or after the current one. */
+        uxShift = uxLevel * listWHEEL_LEVEL_BITS;
+        uxCurrent = (UBaseType_t)(pxWheel->xTime >> uxShift) & (listWHEEL_SLOTS - 1U);
+        ullRotated = pxWheel->ullOccupied[ uxLevel ] >> uxCurrent;
+        if (uxCurrent != 0U) {
+            ullRotated |= pxWheel->ullOccupied[ uxLevel ] << (listWHEEL_SLOTS - uxCurrent);
+        }
+
+        if (uxLevel == 0U) {
+            ullTicks = listCOUNT_TRAILING_ZEROS(ullRotated);
+        }
+        else {
+            /* The current slot of an upper level has already been cascaded,
+            anything in it is a whole rotation away, so it only counts if no
+            other slot is occupied.  Other slots are reached when the levels
+            below next wrap. */
+            ullRotated &= ~1ULL;
+            if (ullRotated != 0ULL) {
+                uxOffset = listCOUNT_TRAILING_ZEROS(ullRotated);
+            }
+            else {
+                uxOffset = listWHEEL_SLOTS;
+            }
+            ullTicks = ((((uint64_t) pxWheel->xTime >> uxShift) + uxOffset) << uxShift) - (uint64_t) pxWheel->xTime;
+        }
+
+        if (ullTicks < ullBest) {
+            ullBest = ullTicks;
+        }
+    }
+
+    if (ullBest == UINT64_MAX) {
+        return portMAX_DELAY;
+    }
+    else if (ullBest <= (uint64_t) xLag) {
+        /* The wheel has fallen behind xTime, something is due already. */
+        return (TickType_t) 0U;
+    }
+    else if ((ullBest - xLag) >= (uint64_t) portMAX_DELAY) {
+        return portMAX_DELAY - (TickType_t) 1U;
+    }
+    else {
+        return (TickType_t)(ullBest - xLag);
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vListInitialiseBuckets(List_t *const pxList, ListBuckets_t *const pxBuckets)
+{
+    UBaseType_t ux;
+
+    configASSERT(listLIST_IS_EMPTY(pxList) != pdFALSE);
+
+    pxBuckets->pxFirst = NULL;
+    pxBuckets->pxFree = NULL;
+
+    for (ux = 0; ux < listBUCKET_HASH_SIZE; ux++) {
+        pxBuckets->pxChains[ ux ] = NULL;
+    }
+
+    /* All the buckets start out on the free list. */
+    for (ux = 0; ux < listBUCKET_COUNT; ux++) {
+        pxBuckets->xBuckets[ ux ].pxNextInChain = pxBuckets->pxFree;
+        pxBuckets->pxFree = &(pxBuckets->xBuckets[ ux ]);
+    }
+
+    pxList->uxOrder = listORDER_PERIOD_BUCKETS;
+    pxList->pxHeapRoot = NULL;
+    pxList->pxWheel = NULL;
+    pxList->pxBuckets = pxBuckets;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* listUSE_ORDERS */
+
 void vListInitialiseItem(ListItem_t *const pxItem)
 {
     /* Make sure the list item is not recorded as being on a list. */
@@ -145,6 +445,14 @@ void vListInsertEnd(List_t *const pxList, ListItem_t *const pxNewListItem)
     pxIndex->pxPrevious->pxNext = pxNewListItem;
     pxIndex->pxPrevious = pxNewListItem;
 
+#if( listUSE_SKIP_LISTS == 1 )
+    {
+        /* The item is not placed by value, so it stays out of the express
+        lanes of a skip list. */
+        pxNewListItem->uxSkipLevels = (UBaseType_t) 0U;
+    }
+#endif
+
     /* Remember which list the item is in. */
     pxNewListItem->pvContainer = (void *) pxList;
 
@@ -155,20 +463,173 @@ void vListInsertEnd(List_t *const pxList, ListItem_t *const pxNewListItem)
 void vListInsert(List_t *const pxList, ListItem_t *const pxNewListItem)
 {
 #ifdef TRACE_TIMING
-    /* get start time of timer insertion */
-    struct timespec ts_start;
-    clock_gettime (CLOCK_MONOTONIC, &ts_start);
+    /* get start time of timer insertion, see TraceClock.h for the clock */
+    uint64_t ullStart = tbClockStart();
 #endif
 
-    ListItem_t *pxIterator;
-    const TickType_t xValueOfInsertion = pxNewListItem->xItemValue;
-
     /* Only effective when configASSERT() is also defined, these tests may catch
     the list data structures being overwritten in memory.  They will not catch
     data errors caused by incorrect configuration or use of FreeRTOS. */
     listTEST_LIST_INTEGRITY(pxList);
     listTEST_LIST_ITEM_INTEGRITY(pxNewListItem);
 
+#if( listUSE_ORDERS == 1 )
+    if (pxList->uxOrder == listORDER_BINARY_HEAP) {
+        prvHeapInsert(pxList, pxNewListItem);
+    }
+    else if (pxList->uxOrder == listORDER_TIMING_WHEEL) {
+        /* Only the wheel orders the items, the list just holds them. */
+        pxNewListItem->pxNext = (ListItem_t *) & (pxList->xListEnd);    /*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+        pxNewListItem->pxPrevious = pxList->xListEnd.pxPrevious;
+        pxList->xListEnd.pxPrevious->pxNext = pxNewListItem;
+        pxList->xListEnd.pxPrevious = pxNewListItem;
+
+        prvWheelLink(pxList->pxWheel, pxNewListItem);
+    }
+    else if (pxList->uxOrder == listORDER_PERIOD_BUCKETS) {
+        prvBucketInsert(pxList, pxNewListItem);
+    }
+#if( listUSE_SKIP_LISTS == 1 )
+    else if (pxList->uxOrder == listORDER_SKIP_LIST) {
+        prvSkipInsert(pxList, pxNewListItem);
+    }
+#endif
+    else
+#endif
+    {
+        prvInsertSorted(pxList, pxNewListItem);
+    }
+
+    /* Remember which list the item is in.  This allows fast removal of the
+    item later. */
+    pxNewListItem->pvContainer = (void *) pxList;
+
+    (pxList->uxNumberOfItems)++;
+
+#ifdef TRACE_TIMING
+    /* get finish time of timer insertion, the time reading the clock takes
+    is not counted */
+    uint64_t ullEnd = tbClockStop();
+    uint32_t ulDuration = tbClockElapsedNs(ullStart, ullEnd);
+
+#ifdef TRACE_HISTOGRAM
+    /* count time, only summaries are printed */
+    tbHistogramRecord(pxList, (uint32_t) pxList->uxNumberOfItems, ulDuration);
+#endif
+
+#ifdef TRACE_BUFFER
+    /* store time, the drain thread writes it out */
+    tbRecord(tbClockToNs(ullStart), pxList, (uint32_t) pxList->uxNumberOfItems, ulDuration);
+#elif !defined( TRACE_HISTOGRAM )
+    /* print time */
+    prints("%s:%u\n", TRACE_LABEL, ulDuration);
+#endif
+#endif
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxListRemove(ListItem_t *const pxItemToRemove)
+{
+    /* The list item knows which list it is in.  Obtain the list from the list
+    item. */
+    List_t *const pxList = (List_t *) pxItemToRemove->pvContainer;
+
+    pxItemToRemove->pxNext->pxPrevious = pxItemToRemove->pxPrevious;
+    pxItemToRemove->pxPrevious->pxNext = pxItemToRemove->pxNext;
+
+    /* Only used during decision coverage testing. */
+    mtCOVERAGE_TEST_DELAY();
+
+    /* Make sure the index is left pointing to a valid item. */
+    if (pxList->pxIndex == pxItemToRemove) {
+        pxList->pxIndex = pxItemToRemove->pxPrevious;
+    }
+    else {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+#if( listUSE_ORDERS == 1 )
+    if (pxList->uxOrder == listORDER_BINARY_HEAP) {
+        prvHeapRemove(pxList, pxItemToRemove);
+    }
+    else if (pxList->uxOrder == listORDER_TIMING_WHEEL) {
+        prvWheelUnlink(pxList->pxWheel, pxItemToRemove);
+    }
+    else if (pxList->uxOrder == listORDER_PERIOD_BUCKETS) {
+        prvBucketRemove(pxList, pxItemToRemove);
+    }
+#if( listUSE_SKIP_LISTS == 1 )
+    else if (pxList->uxOrder == listORDER_SKIP_LIST) {
+        prvSkipRemove(pxList, pxItemToRemove);
+    }
+#endif
+    else {
+        mtCOVERAGE_TEST_MARKER();
+    }
+#endif
+
+    pxItemToRemove->pvContainer = NULL;
+    (pxList->uxNumberOfItems)--;
+
+    return pxList->uxNumberOfItems;
+}
+/*-----------------------------------------------------------*/
+
+void vListGetStats(const List_t *const pxList, ListStats_t *const pxStats)
+{
+    pxStats->uxNumberOfItems = pxList->uxNumberOfItems;
+    pxStats->xItemSize = sizeof(ListItem_t);
+    pxStats->xListSize = sizeof(List_t);
+    pxStats->uxSkipLinks = (UBaseType_t) 0U;
+
+#if( listUSE_ORDERS == 1 )
+    {
+        pxStats->uxOrder = pxList->uxOrder;
+
+        /* The ordering members are the last ones of the item, only followed
+        by the integrity check value if there is one. */
+        pxStats->xItemOrderSize = sizeof(ListItem_t) - offsetof(ListItem_t, pxOrderParent);
+#if( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
+        pxStats->xItemOrderSize -= sizeof(TickType_t);
+#endif
+
+        if (pxList->pxWheel != NULL) {
+            pxStats->xStorageSize = sizeof(ListWheel_t);
+        }
+        else if (pxList->pxBuckets != NULL) {
+            pxStats->xStorageSize = sizeof(ListBuckets_t);
+        }
+        else {
+            pxStats->xStorageSize = 0U;
+        }
+    }
+#else
+    {
+        pxStats->uxOrder = listORDER_SORTED_LIST;
+        pxStats->xItemOrderSize = 0U;
+        pxStats->xStorageSize = 0U;
+    }
+#endif
+
+#if( listUSE_SKIP_LISTS == 1 )
+    {
+        const ListItem_t *pxItem;
+
+        if (pxList->uxOrder == listORDER_SKIP_LIST) {
+            for (pxItem = pxList->xListEnd.pxNext; pxItem != (const ListItem_t *) & (pxList->xListEnd); pxItem = pxItem->pxNext) {   /*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+                pxStats->uxSkipLinks += pxItem->uxSkipLevels;
+            }
+        }
+    }
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertSorted(List_t *const pxList, ListItem_t *const pxNewListItem)
+{
+    ListItem_t *pxIterator;
+    const TickType_t xValueOfInsertion = pxNewListItem->xItemValue;
+
     /* Insert the new list item into the list, sorted in xItemValue order.
 
     If the list already contains a list item with the same item value then the
@@ -213,53 +674,618 @@ void vListInsert(List_t *const pxList, ListItem_t *const pxNewListItem)
     pxNewListItem->pxNext->pxPrevious = pxNewListItem;
     pxNewListItem->pxPrevious = pxIterator;
     pxIterator->pxNext = pxNewListItem;
+}
+/*-----------------------------------------------------------*/
 
-    /* Remember which list the item is in.  This allows fast removal of the
-    item later. */
-    pxNewListItem->pvContainer = (void *) pxList;
 
-    (pxList->uxNumberOfItems)++;
+#if( listUSE_ORDERS == 1 )
 
-#ifdef TRACE_TIMING
-    /* get finish time of timer insertion */
-    struct timespec ts_end;
-    clock_gettime (CLOCK_MONOTONIC, &ts_end);
+static ListItem_t *prvHeapItemAt(const List_t *const pxList, UBaseType_t uxPosition)
+{
+    ListItem_t *pxItem = pxList->pxHeapRoot;
+    UBaseType_t uxBit = (UBaseType_t) 1U << ((sizeof(UBaseType_t) * 8U) - 1U);
 
-    /* calculate and print time */
-    if ((ts_end.tv_nsec - ts_start.tv_nsec) < 0) {
-        prints("%s:%ld\n", TRACE_LABEL, ((ts_end.tv_nsec - ts_start.tv_nsec) + 1000000000));
+    /* Positions are numbered from 1 in breadth first order, so the bits below
+    the most significant set bit of the position spell out the path from the
+    root - 0 for left and 1 for right. */
+    while ((uxBit & uxPosition) == (UBaseType_t) 0U) {
+        uxBit >>= 1U;
+    }
+
+    for (uxBit >>= 1U; uxBit != (UBaseType_t) 0U; uxBit >>= 1U) {
+        if ((uxPosition & uxBit) == (UBaseType_t) 0U) {
+            pxItem = pxItem->pxOrderLeft;
+        }
+        else {
+            pxItem = pxItem->pxOrderRight;
+        }
+    }
+
+    return pxItem;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapSwapWithParent(List_t *const pxList, ListItem_t *const pxChild)
+{
+    ListItem_t *const pxParent = pxChild->pxOrderParent;
+    ListItem_t *const pxGrandParent = pxParent->pxOrderParent;
+    ListItem_t *const pxChildLeft = pxChild->pxOrderLeft;
+    ListItem_t *const pxChildRight = pxChild->pxOrderRight;
+
+    /* The child takes the place of the parent, keeping its sibling. */
+    if (pxParent->pxOrderLeft == pxChild) {
+        pxChild->pxOrderLeft = pxParent;
+        pxChild->pxOrderRight = pxParent->pxOrderRight;
+        if (pxChild->pxOrderRight != NULL) {
+            pxChild->pxOrderRight->pxOrderParent = pxChild;
+        }
     }
     else {
-        prints("%s:%ld\n", TRACE_LABEL, (ts_end.tv_nsec - ts_start.tv_nsec));
+        pxChild->pxOrderRight = pxParent;
+        pxChild->pxOrderLeft = pxParent->pxOrderLeft;
+        if (pxChild->pxOrderLeft != NULL) {
+            pxChild->pxOrderLeft->pxOrderParent = pxChild;
+        }
+    }
+
+    /* The parent takes over the children of the child. */
+    pxParent->pxOrderLeft = pxChildLeft;
+    if (pxChildLeft != NULL) {
+        pxChildLeft->pxOrderParent = pxParent;
+    }
+    pxParent->pxOrderRight = pxChildRight;
+    if (pxChildRight != NULL) {
+        pxChildRight->pxOrderParent = pxParent;
+    }
+    pxParent->pxOrderParent = pxChild;
+
+    /* Hook the child into the grand parent, or make it the root. */
+    pxChild->pxOrderParent = pxGrandParent;
+    if (pxGrandParent == NULL) {
+        pxList->pxHeapRoot = pxChild;
+    }
+    else if (pxGrandParent->pxOrderLeft == pxParent) {
+        pxGrandParent->pxOrderLeft = pxChild;
+    }
+    else {
+        pxGrandParent->pxOrderRight = pxChild;
     }
-#endif
 }
 /*-----------------------------------------------------------*/
 
-UBaseType_t uxListRemove(ListItem_t *const pxItemToRemove)
+static void prvHeapSiftUp(List_t *const pxList, ListItem_t *const pxItem)
 {
-    /* The list item knows which list it is in.  Obtain the list from the list
-    item. */
-    List_t *const pxList = (List_t *) pxItemToRemove->pvContainer;
+    /* Strictly less than, so an item never overtakes an item of equal value
+    that is already in the heap. */
+    while ((pxItem->pxOrderParent != NULL) && (pxItem->xItemValue < pxItem->pxOrderParent->xItemValue)) {
+        prvHeapSwapWithParent(pxList, pxItem);
+    }
+}
+/*-----------------------------------------------------------*/
 
-    pxItemToRemove->pxNext->pxPrevious = pxItemToRemove->pxPrevious;
-    pxItemToRemove->pxPrevious->pxNext = pxItemToRemove->pxNext;
+static void prvHeapSiftDown(List_t *const pxList, ListItem_t *const pxItem)
+{
+    ListItem_t *pxSmallest;
 
-    /* Only used during decision coverage testing. */
-    mtCOVERAGE_TEST_DELAY();
+    for (;;) {
+        pxSmallest = pxItem;
 
-    /* Make sure the index is left pointing to a valid item. */
-    if (pxList->pxIndex == pxItemToRemove) {
-        pxList->pxIndex = pxItemToRemove->pxPrevious;
+        if ((pxItem->pxOrderLeft != NULL) && (pxItem->pxOrderLeft->xItemValue < pxSmallest->xItemValue)) {
+            pxSmallest = pxItem->pxOrderLeft;
+        }
+        if ((pxItem->pxOrderRight != NULL) && (pxItem->pxOrderRight->xItemValue < pxSmallest->xItemValue)) {
+            pxSmallest = pxItem->pxOrderRight;
+        }
+
+        if (pxSmallest == pxItem) {
+            break;
+        }
+
+        prvHeapSwapWithParent(pxList, pxSmallest);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInsert(List_t *const pxList, ListItem_t *const pxNewListItem)
+{
+    /* uxNumberOfItems is only incremented by the caller, so the new item
+    takes the next free position in the tree. */
+    const UBaseType_t uxPosition = pxList->uxNumberOfItems + (UBaseType_t) 1U;
+    ListItem_t *pxParent;
+    ListItem_t *pxAfter;
+
+    pxNewListItem->pxOrderLeft = NULL;
+    pxNewListItem->pxOrderRight = NULL;
+
+    if (uxPosition == (UBaseType_t) 1U) {
+        pxNewListItem->pxOrderParent = NULL;
+        pxList->pxHeapRoot = pxNewListItem;
+    }
+    else {
+        pxParent = prvHeapItemAt(pxList, uxPosition >> 1U);
+        pxNewListItem->pxOrderParent = pxParent;
+
+        if ((uxPosition & (UBaseType_t) 1U) == (UBaseType_t) 0U) {
+            pxParent->pxOrderLeft = pxNewListItem;
+        }
+        else {
+            pxParent->pxOrderRight = pxNewListItem;
+        }
+
+        prvHeapSiftUp(pxList, pxNewListItem);
+    }
+
+    /* Link the item into the list as well, so the list can still be walked.
+    The root of the heap is kept at the head of the list, every other item
+    goes to the back. */
+    if (pxList->pxHeapRoot == pxNewListItem) {
+        pxAfter = (ListItem_t *) & (pxList->xListEnd);    /*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+    }
+    else {
+        pxAfter = pxList->xListEnd.pxPrevious;
+    }
+
+    pxNewListItem->pxNext = pxAfter->pxNext;
+    pxNewListItem->pxNext->pxPrevious = pxNewListItem;
+    pxNewListItem->pxPrevious = pxAfter;
+    pxAfter->pxNext = pxNewListItem;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapRemove(List_t *const pxList, ListItem_t *const pxItemToRemove)
+{
+    ListItem_t *const pxLast = prvHeapItemAt(pxList, pxList->uxNumberOfItems);
+
+    /* Detach the last node of the tree, it fills the gap left by the item
+    being removed. */
+    if (pxLast->pxOrderParent == NULL) {
+        pxList->pxHeapRoot = NULL;
+    }
+    else if (pxLast->pxOrderParent->pxOrderLeft == pxLast) {
+        pxLast->pxOrderParent->pxOrderLeft = NULL;
+    }
+    else {
+        pxLast->pxOrderParent->pxOrderRight = NULL;
+    }
+
+    if (pxLast != pxItemToRemove) {
+        pxLast->pxOrderParent = pxItemToRemove->pxOrderParent;
+        pxLast->pxOrderLeft = pxItemToRemove->pxOrderLeft;
+        pxLast->pxOrderRight = pxItemToRemove->pxOrderRight;
+
+        if (pxLast->pxOrderParent == NULL) {
+            pxList->pxHeapRoot = pxLast;
+        }
+        else if (pxLast->pxOrderParent->pxOrderLeft == pxItemToRemove) {
+            pxLast->pxOrderParent->pxOrderLeft = pxLast;
+        }
+        else {
+            pxLast->pxOrderParent->pxOrderRight = pxLast;
+        }
+        if (pxLast->pxOrderLeft != NULL) {
+            pxLast->pxOrderLeft->pxOrderParent = pxLast;
+        }
+        if (pxLast->pxOrderRight != NULL) {
+            pxLast->pxOrderRight->pxOrderParent = pxLast;
+        }
+
+        if ((pxLast->pxOrderParent != NULL) && (pxLast->xItemValue < pxLast->pxOrderParent->xItemValue)) {
+            prvHeapSiftUp(pxList, pxLast);
+        }
+        else {
+            prvHeapSiftDown(pxList, pxLast);
+        }
     }
     else {
         mtCOVERAGE_TEST_MARKER();
     }
 
-    pxItemToRemove->pvContainer = NULL;
-    (pxList->uxNumberOfItems)--;
+    pxItemToRemove->pxOrderParent = NULL;
+    pxItemToRemove->pxOrderLeft = NULL;
+    pxItemToRemove->pxOrderRight = NULL;
 
-    return pxList->uxNumberOfItems;
+    /* The item has already been unlinked from the list.  If it was the root
+    the new root has to be moved up to the head of the list. */
+    if (pxList->pxHeapRoot != NULL) {
+        prvMoveToHead(pxList, pxList->pxHeapRoot);
+    }
+    else {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelLink(ListWheel_t *const pxWheel, ListItem_t *const pxItem)
+{
+    const TickType_t xDelta = pxItem->xItemValue - pxWheel->xTime;
+    UBaseType_t uxLevel = 0U;
+    UBaseType_t uxSlot;
+    ListItem_t *pxSlot;
+
+    /* The level is chosen by the distance from the current time, the slot
+    within it by the item value itself so the slot is reached exactly when the
+    levels below wrap to it. */
+    while ((uxLevel < (listWHEEL_LEVELS - 1U)) && ((xDelta >> ((uxLevel + 1U) * listWHEEL_LEVEL_BITS)) != (TickType_t) 0U)) {
+        uxLevel++;
+    }
+
+    uxSlot = (UBaseType_t)(pxItem->xItemValue >> (uxLevel * listWHEEL_LEVEL_BITS)) & (listWHEEL_SLOTS - 1U);
+    pxSlot = &(pxWheel->xSlots[ uxLevel ][ uxSlot ]);
+
+    pxItem->pxOrderParent = pxSlot;
+    pxItem->pxOrderRight = pxSlot;
+    pxItem->pxOrderLeft = pxSlot->pxOrderLeft;
+    pxSlot->pxOrderLeft->pxOrderRight = pxItem;
+    pxSlot->pxOrderLeft = pxItem;
+
+    pxWheel->ullOccupied[ uxLevel ] |= (1ULL << uxSlot);
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelUnlink(ListWheel_t *const pxWheel, ListItem_t *const pxItem)
+{
+    ListItem_t *const pxSlot = pxItem->pxOrderParent;
+    UBaseType_t uxIndex;
+
+    pxItem->pxOrderLeft->pxOrderRight = pxItem->pxOrderRight;
+    pxItem->pxOrderRight->pxOrderLeft = pxItem->pxOrderLeft;
+    pxItem->pxOrderParent = NULL;
+
+    if (pxSlot->pxOrderRight == pxSlot) {
+        uxIndex = (UBaseType_t)(pxSlot - &(pxWheel->xSlots[ 0 ][ 0 ]));
+        pxWheel->ullOccupied[ uxIndex / listWHEEL_SLOTS ] &= ~(1ULL << (uxIndex % listWHEEL_SLOTS));
+    }
+    else {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelCascade(ListWheel_t *const pxWheel)
+{
+    const TickType_t xTime = pxWheel->xTime;
+    UBaseType_t uxLevel, uxShift, uxSlot;
+    ListItem_t *pxSlot, *pxItem, *pxNext;
+
+    /* Each level whose lower levels have all wrapped to zero hands the items
+    of its current slot down.  They are at most one slot width away now, so
+    they all land on a lower level. */
+    for (uxLevel = 1U; uxLevel < listWHEEL_LEVELS; uxLevel++) {
+        uxShift = uxLevel * listWHEEL_LEVEL_BITS;
+        if ((xTime & ((((TickType_t) 1U) << uxShift) - (TickType_t) 1U)) != (TickType_t) 0U) {
+            break;
+        }
+
+        uxSlot = (UBaseType_t)(xTime >> uxShift) & (listWHEEL_SLOTS - 1U);
+        pxSlot = &(pxWheel->xSlots[ uxLevel ][ uxSlot ]);
+        if (pxSlot->pxOrderRight == pxSlot) {
+            continue;
+        }
+
+        /* Detach the whole slot before relinking its items. */
+        pxItem = pxSlot->pxOrderRight;
+        pxSlot->pxOrderLeft->pxOrderRight = NULL;
+        pxSlot->pxOrderLeft = pxSlot;
+        pxSlot->pxOrderRight = pxSlot;
+        pxWheel->ullOccupied[ uxLevel ] &= ~(1ULL << uxSlot);
+
+        while (pxItem != NULL) {
+            pxNext = pxItem->pxOrderRight;
+            prvWheelLink(pxWheel, pxItem);
+            pxItem = pxNext;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static ListBucket_t *prvBucketFind(const ListBuckets_t *const pxBuckets, TickType_t xKey)
+{
+    ListBucket_t *pxBucket;
+
+    for (pxBucket = pxBuckets->pxChains[ xKey & (listBUCKET_HASH_SIZE - 1U) ]; pxBucket != NULL; pxBucket = pxBucket->pxNextInChain) {
+        if (pxBucket->xKey == xKey) {
+            break;
+        }
+    }
+
+    return pxBucket;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBucketPlace(ListBuckets_t *const pxBuckets, ListBucket_t *const pxBucket, ListBucket_t *pxPrevious)
+{
+    const TickType_t xValue = pxBucket->xItems.pxOrderRight->xItemValue;
+    ListBucket_t *pxNext;
+
+    /* pxPrevious, if not NULL, is a bucket whose first item is known not to
+    be after the first item of this bucket, so the search can start there.
+    Buckets with equal first values stay in the order they were placed. */
+    if (pxPrevious == NULL) {
+        pxNext = pxBuckets->pxFirst;
+    }
+    else {
+        pxNext = pxPrevious->pxNext;
+    }
+
+    while ((pxNext != NULL) && (pxNext->xItems.pxOrderRight->xItemValue <= xValue)) {
+        pxPrevious = pxNext;
+        pxNext = pxNext->pxNext;
+    }
+
+    pxBucket->pxPrevious = pxPrevious;
+    pxBucket->pxNext = pxNext;
+
+    if (pxPrevious == NULL) {
+        pxBuckets->pxFirst = pxBucket;
+    }
+    else {
+        pxPrevious->pxNext = pxBucket;
+    }
+    if (pxNext != NULL) {
+        pxNext->pxPrevious = pxBucket;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBucketDetach(ListBuckets_t *const pxBuckets, ListBucket_t *const pxBucket)
+{
+    if (pxBucket->pxPrevious == NULL) {
+        pxBuckets->pxFirst = pxBucket->pxNext;
+    }
+    else {
+        pxBucket->pxPrevious->pxNext = pxBucket->pxNext;
+    }
+    if (pxBucket->pxNext != NULL) {
+        pxBucket->pxNext->pxPrevious = pxBucket->pxPrevious;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBucketInsert(List_t *const pxList, ListItem_t *const pxNewListItem)
+{
+    ListBuckets_t *const pxBuckets = pxList->pxBuckets;
+    const TickType_t xValueOfInsertion = pxNewListItem->xItemValue;
+    ListBucket_t *pxBucket = prvBucketFind(pxBuckets, pxNewListItem->xBucketKey);
+    ListItem_t *pxAfter;
+
+    if (pxBucket == NULL) {
+        pxBucket = pxBuckets->pxFree;
+
+        if (pxBucket != NULL) {
+            pxBuckets->pxFree = pxBucket->pxNextInChain;
+
+            pxBucket->xKey = pxNewListItem->xBucketKey;
+            pxBucket->pxNextInChain = pxBuckets->pxChains[ pxBucket->xKey & (listBUCKET_HASH_SIZE - 1U) ];
+            pxBuckets->pxChains[ pxBucket->xKey & (listBUCKET_HASH_SIZE - 1U) ] = pxBucket;
+
+            pxBucket->xItems.pxOrderLeft = &(pxBucket->xItems);
+            pxBucket->xItems.pxOrderRight = &(pxBucket->xItems);
+        }
+        else {
+            /* Out of buckets, share the first one.  The walk below keeps it
+            sorted. */
+            pxBucket = pxBuckets->pxFirst;
+        }
+    }
+    else {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    /* Items of one key normally arrive in increasing value order, so the
+    walk back from the tail of the bucket stops straight away. */
+    for (pxAfter = pxBucket->xItems.pxOrderLeft; (pxAfter != &(pxBucket->xItems)) && (pxAfter->xItemValue > xValueOfInsertion); pxAfter = pxAfter->pxOrderLeft) {
+        /* There is nothing to do here, just iterating to the wanted
+        insertion position. */
+    }
+
+    pxNewListItem->pxOrderParent = &(pxBucket->xItems);
+    pxNewListItem->pxOrderLeft = pxAfter;
+    pxNewListItem->pxOrderRight = pxAfter->pxOrderRight;
+    pxAfter->pxOrderRight->pxOrderLeft = pxNewListItem;
+    pxAfter->pxOrderRight = pxNewListItem;
+
+    /* A new first item changes the position of the bucket in the chain. */
+    if (pxAfter == &(pxBucket->xItems)) {
+        if (pxNewListItem->pxOrderRight != &(pxBucket->xItems)) {
+            prvBucketDetach(pxBuckets, pxBucket);
+        }
+        else {
+            mtCOVERAGE_TEST_MARKER();
+        }
+        prvBucketPlace(pxBuckets, pxBucket, NULL);
+    }
+    else {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    /* Link the item into the list as well.  The lowest item is kept at the
+    head of the list, every other item goes to the back. */
+    if (pxBuckets->pxFirst->xItems.pxOrderRight == pxNewListItem) {
+        pxAfter = (ListItem_t *) & (pxList->xListEnd);    /*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+    }
+    else {
+        pxAfter = pxList->xListEnd.pxPrevious;
+    }
+
+    pxNewListItem->pxNext = pxAfter->pxNext;
+    pxNewListItem->pxNext->pxPrevious = pxNewListItem;
+    pxNewListItem->pxPrevious = pxAfter;
+    pxAfter->pxNext = pxNewListItem;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBucketRemove(List_t *const pxList, ListItem_t *const pxItemToRemove)
+{
+    ListBuckets_t *const pxBuckets = pxList->pxBuckets;
+    ListBucket_t *const pxBucket = (ListBucket_t *) pxItemToRemove->pxOrderParent;   /*lint !e740 xItems is the first member of the bucket. */
+    const BaseType_t xWasFirst = (pxBucket->xItems.pxOrderRight == pxItemToRemove) ? pdTRUE : pdFALSE;
+    ListBucket_t *pxPrevious;
+    ListBucket_t **ppxChain;
+
+    pxItemToRemove->pxOrderLeft->pxOrderRight = pxItemToRemove->pxOrderRight;
+    pxItemToRemove->pxOrderRight->pxOrderLeft = pxItemToRemove->pxOrderLeft;
+    pxItemToRemove->pxOrderParent = NULL;
+    pxItemToRemove->pxOrderLeft = NULL;
+    pxItemToRemove->pxOrderRight = NULL;
+
+    if (pxBucket->xItems.pxOrderRight == &(pxBucket->xItems)) {
+        /* The bucket is empty, return it to the free list. */
+        prvBucketDetach(pxBuckets, pxBucket);
+
+        for (ppxChain = &(pxBuckets->pxChains[ pxBucket->xKey & (listBUCKET_HASH_SIZE - 1U) ]); *ppxChain != pxBucket; ppxChain = &((*ppxChain)->pxNextInChain)) {
+            /* There is nothing to do here, just looking for the bucket. */
+        }
+        *ppxChain = pxBucket->pxNextInChain;
+
+        pxBucket->pxNextInChain = pxBuckets->pxFree;
+        pxBuckets->pxFree = pxBucket;
+    }
+    else if (xWasFirst != pdFALSE) {
+        /* The first value of the bucket has grown, it can only move back
+        in the chain. */
+        pxPrevious = pxBucket->pxPrevious;
+        prvBucketDetach(pxBuckets, pxBucket);
+        prvBucketPlace(pxBuckets, pxBucket, pxPrevious);
+    }
+    else {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    /* The item has already been unlinked from the list.  If it was the lowest
+    the new lowest item has to be moved up to the head of the list. */
+    if (pxBuckets->pxFirst != NULL) {
+        prvMoveToHead(pxList, pxBuckets->pxFirst->xItems.pxOrderRight);
+    }
+    else {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMoveToHead(List_t *const pxList, ListItem_t *const pxItem)
+{
+    ListItem_t *const pxListEnd = (ListItem_t *) & (pxList->xListEnd);   /*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+
+    if (pxListEnd->pxNext != pxItem) {
+        if (pxList->pxIndex == pxItem) {
+            pxList->pxIndex = pxItem->pxPrevious;
+        }
+
+        pxItem->pxNext->pxPrevious = pxItem->pxPrevious;
+        pxItem->pxPrevious->pxNext = pxItem->pxNext;
+
+        pxItem->pxNext = pxListEnd->pxNext;
+        pxItem->pxNext->pxPrevious = pxItem;
+        pxItem->pxPrevious = pxListEnd;
+        pxListEnd->pxNext = pxItem;
+    }
+    else {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+#endif /* listUSE_ORDERS */
+
+#if( listUSE_SKIP_LISTS == 1 )
+
+static UBaseType_t prvSkipRandomLevels(void)
+{
+    UBaseType_t uxLevels = 0U;
+
+    /* xorshift32, every pair of zero bits lifts the item one lane higher so
+    each lane holds about a quarter of the items of the one below. */
+    ulSkipRandom ^= ulSkipRandom << 13;
+    ulSkipRandom ^= ulSkipRandom >> 17;
+    ulSkipRandom ^= ulSkipRandom << 5;
+
+    while ((uxLevels < listSKIP_LEVELS) && (((ulSkipRandom >> (uxLevels * 2U)) & 3UL) == 0UL)) {
+        uxLevels++;
+    }
+
+    return uxLevels;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSkipInsert(List_t *const pxList, ListItem_t *const pxNewListItem)
+{
+    ListItem_t *const pxListEnd = (ListItem_t *) & (pxList->xListEnd);  /*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+    const TickType_t xValueOfInsertion = pxNewListItem->xItemValue;
+    const UBaseType_t uxLevels = prvSkipRandomLevels();
+    ListItem_t *pxPrevious[ listSKIP_LEVELS ];
+    ListItem_t *pxIterator = NULL;
+    ListItem_t *pxNext;
+    UBaseType_t uxLevel;
+
+    /* Find the last item not greater than the new one on every lane, from the
+    top down, so equal values keep their insertion order as in a sorted list.
+    NULL stands for the head of a lane. */
+    for (uxLevel = listSKIP_LEVELS; uxLevel > 0U; uxLevel--) {
+        pxNext = (pxIterator == NULL) ? pxList->pxSkipHead[ uxLevel - 1U ] : pxIterator->pxSkipNext[ uxLevel - 1U ];
+
+        while ((pxNext != NULL) && (pxNext->xItemValue <= xValueOfInsertion)) {
+            pxIterator = pxNext;
+            pxNext = pxIterator->pxSkipNext[ uxLevel - 1U ];
+        }
+
+        pxPrevious[ uxLevel - 1U ] = pxIterator;
+    }
+
+    /* The lowest lane leaves only a few items to walk in the list itself. */
+    if (pxIterator == NULL) {
+        pxIterator = pxListEnd;
+    }
+
+    while ((pxIterator->pxNext != pxListEnd) && (pxIterator->pxNext->xItemValue <= xValueOfInsertion)) {
+        pxIterator = pxIterator->pxNext;
+    }
+
+    pxNewListItem->pxNext = pxIterator->pxNext;
+    pxNewListItem->pxNext->pxPrevious = pxNewListItem;
+    pxNewListItem->pxPrevious = pxIterator;
+    pxIterator->pxNext = pxNewListItem;
+
+    /* Link the item into its express lanes. */
+    pxNewListItem->uxSkipLevels = uxLevels;
+
+    for (uxLevel = 0U; uxLevel < uxLevels; uxLevel++) {
+        pxNewListItem->pxSkipPrevious[ uxLevel ] = pxPrevious[ uxLevel ];
+
+        if (pxPrevious[ uxLevel ] == NULL) {
+            pxNewListItem->pxSkipNext[ uxLevel ] = pxList->pxSkipHead[ uxLevel ];
+            pxList->pxSkipHead[ uxLevel ] = pxNewListItem;
+        }
+        else {
+            pxNewListItem->pxSkipNext[ uxLevel ] = pxPrevious[ uxLevel ]->pxSkipNext[ uxLevel ];
+            pxPrevious[ uxLevel ]->pxSkipNext[ uxLevel ] = pxNewListItem;
+        }
+
+        if (pxNewListItem->pxSkipNext[ uxLevel ] != NULL) {
+            pxNewListItem->pxSkipNext[ uxLevel ]->pxSkipPrevious[ uxLevel ] = pxNewListItem;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSkipRemove(List_t *const pxList, ListItem_t *const pxItemToRemove)
+{
+    UBaseType_t uxLevel;
+
+    for (uxLevel = 0U; uxLevel < pxItemToRemove->uxSkipLevels; uxLevel++) {
+        if (pxItemToRemove->pxSkipPrevious[ uxLevel ] == NULL) {
+            pxList->pxSkipHead[ uxLevel ] = pxItemToRemove->pxSkipNext[ uxLevel ];
+        }
+        else {
+            pxItemToRemove->pxSkipPrevious[ uxLevel ]->pxSkipNext[ uxLevel ] = pxItemToRemove->pxSkipNext[ uxLevel ];
+        }
+
+        if (pxItemToRemove->pxSkipNext[ uxLevel ] != NULL) {
+            pxItemToRemove->pxSkipNext[ uxLevel ]->pxSkipPrevious[ uxLevel ] = pxItemToRemove->pxSkipPrevious[ uxLevel ];
+        }
+    }
+
+    pxItemToRemove->uxSkipLevels = (UBaseType_t) 0U;
 }
 /*-----------------------------------------------------------*/
 
+#endif /* listUSE_SKIP_LISTS */
@@ -60,41 +60,87 @@
 #include <errno.h>
 #include <sys/time.h>
 #include <time.h>
-#include <sys/times.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <limits.h>
+#include <sys/mman.h>
 
 /* Scheduler includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+
+#if( configUSE_FUTEX_HANDOFF == 1 )
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#if( configUSE_VIRTUAL_TIME == 0 )
+#include <stdint.h>
+#if( configUSE_TICK_THREAD == 1 )
+#include <sys/timerfd.h>
+#endif
+#endif
 /*-----------------------------------------------------------*/
 
-//#define MAX_NUMBER_OF_TASKS (_POSIX_THREAD_THREADS_MAX)
-#define MAX_NUMBER_OF_TASKS 1024
+/* Thread states are allocated in blocks of this many as the tasks are created,
+so the number of tasks is only limited by the memory. */
+#define THREAD_STATES_PER_BLOCK 1024
 /*-----------------------------------------------------------*/
 
+/* A stack of the pool the task threads run on.  A guard page below it turns
+an overflow into a fault.  Stacks are only handed out again once their thread
+has been joined, so no thread that is still ending runs on them. */
+typedef struct THREAD_STACK {
+    struct THREAD_STACK *pxNext;
+    void *pvStack;      /* Lowest address of the stack, above the guard page. */
+    pthread_t hThread;  /* Thread that ran on it last. */
+} xThreadStack;
+
 /* Parameters to pass to the newly created pthread. */
 typedef struct XPARAMS {
     pdTASK_CODE pxCode;
     void *pvParams;
+    struct THREAD_SUSPENSIONS *pxThread;
 } xParams;
 
-/* Each task maintains its own interrupt status in the critical nesting variable. */
+/* Each task maintains its own interrupt status in the critical nesting variable.
+pxTopOfStack, the first member of the TCB, points to the state of the task's
+thread, so it is found without searching the thread states. */
 typedef struct THREAD_SUSPENSIONS {
     pthread_t hThread;
     xTaskHandle hTask;
     unsigned portBASE_TYPE uxCriticalNesting;
+    xThreadStack *pxStack;
+#if( configUSE_FUTEX_HANDOFF == 1 )
+    int iRunning;   /* Futex word, 1 while the thread may run. */
+#endif
 } xThreadState;
+
+/* A block never moves once allocated, the TCBs point into it. */
+typedef struct THREAD_STATE_BLOCK {
+    struct THREAD_STATE_BLOCK *pxNext;
+    xThreadState xStates[THREAD_STATES_PER_BLOCK];
+} xThreadStateBlock;
 /*-----------------------------------------------------------*/
 
-static xThreadState *pxThreads;
+static xThreadStateBlock *pxThreadBlocks = NULL;
+static unsigned portBASE_TYPE uxThreadStatesUsed = THREAD_STATES_PER_BLOCK;
+/* pdFALSE once threads of a run did not end and kept their states. */
+static portBASE_TYPE xThreadsEnded = pdTRUE;
 static pthread_once_t hSigSetupThread = PTHREAD_ONCE_INIT;
 static pthread_attr_t xThreadAttributes;
 static pthread_mutex_t xSuspendResumeThreadMutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t xSingleThreadMutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_t hMainThread = (pthread_t)NULL;
+
+/* Stacks that can be used, and stacks of threads that ended but are not
+joined yet.  The pool is kept when the scheduler ends, so the next run creates
+its threads on the same stacks. */
+static xThreadStack *pxFreeStacks = NULL;
+static xThreadStack *pxEndedStacks = NULL;
+static pthread_mutex_t xThreadStackMutex = PTHREAD_MUTEX_INITIALIZER;
 /*-----------------------------------------------------------*/
 
 static volatile portBASE_TYPE xSentinel = 0;
@@ -102,26 +148,65 @@ static volatile portBASE_TYPE xSchedulerEnd = pdFALSE;
 static volatile portBASE_TYPE xInterruptsEnabled = pdTRUE;
 static volatile portBASE_TYPE xServicingTick = pdFALSE;
 static volatile portBASE_TYPE xPendYield = pdFALSE;
-static volatile portLONG lIndexOfLastAddedTask = 0;
+static xThreadState *volatile pxLastAddedThread = NULL;
 static volatile unsigned portBASE_TYPE uxCriticalNesting;
+
+#if( configUSE_FUTEX_HANDOFF == 1 )
+/* State of the calling thread, set when the thread starts. */
+static __thread xThreadState *pxThisThread = NULL;
+#endif
+
+#if( configUSE_VIRTUAL_TIME == 0 )
+/* Ticks that occurred and are not processed yet.  Only the count is handed
+over, so ticks that come while the interrupts are disabled are caught up
+instead of being lost. */
+static uint64_t ullPendingTicks = 0;
+
+/* See vPortGetTickStats(), the times are those of the timer. */
+static uint64_t ullTicksProcessed = 0;
+static uint64_t ullTicksDeferred = 0;
+static uint64_t ullTickStartTime = 0;
+static uint64_t ullTickEndTime = 0;
+
+#if( configUSE_TICK_THREAD == 1 )
+static pthread_t hTickThread;
+static int iTickTimer = -1;
+#endif
+#else
+/* Ticks stepped over and incremented by the idle task, see
+vPortGetTickStats(). */
+static uint64_t ullTicksProcessed = 0;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
  * Setup the timer to generate the tick interrupts.
  */
+#if( configUSE_VIRTUAL_TIME == 0 )
 static void prvSetupTimerInterrupt(void);
+static void prvStopTimerInterrupt(void);
+static uint64_t prvGetTime(void);
+static void prvProcessPendingTicks(void);
+static void prvCatchUpTicks(void);
+#if( configUSE_TICK_THREAD == 1 )
+static void *prvTickThread(void *pvParams);
+#endif
+#endif
 static void *prvWaitForStart(void *pvParams);
+#if( configUSE_FUTEX_HANDOFF == 0 )
 static void prvSuspendSignalHandler(int sig);
 static void prvResumeSignalHandler(int sig);
+#endif
 static void prvSetupSignalsAndSchedulerPolicy(void);
-static void prvSuspendThread(pthread_t xThreadId);
-static void prvResumeThread(pthread_t xThreadId);
-static pthread_t prvGetThreadHandle(xTaskHandle hTask);
-static portLONG prvGetFreeThreadState(void);
-static void prvSetTaskCriticalNesting(pthread_t xThreadId,
-                                      unsigned portBASE_TYPE uxNesting);
-static unsigned portBASE_TYPE prvGetTaskCriticalNesting(pthread_t xThreadId);
-static void prvDeleteThread(void *xThreadId);
+static void prvSuspendThread(xThreadState *pxThread);
+static void prvResumeThread(xThreadState *pxThread);
+static xThreadState *prvGetThreadState(xTaskHandle hTask);
+static xThreadState *prvGetFreeThreadState(void);
+static void prvDeleteThread(void *pvThread);
+static xThreadStack *prvTakeThreadStack(void);
+static void prvJoinEndedThreads(void);
+static void prvCancelThread(xThreadState *pxThread);
+static BaseType_t prvResetThreadStates(void);
 /*-----------------------------------------------------------*/
 
 /*
@@ -151,10 +236,8 @@ portSTACK_TYPE *pxPortInitialiseStack(portSTACK_TYPE *pxTopOfStack,
         hMainThread = pthread_self();
     }
 
-    /* No need to join the threads. */
+    /* The threads are joined before their stacks are used again. */
     pthread_attr_init(&xThreadAttributes);
-    pthread_attr_setdetachstate(&xThreadAttributes,
-                                PTHREAD_CREATE_DETACHED);
 
     /* Add the task parameters. */
     pxThisThreadParams->pxCode = pxCode;
@@ -162,23 +245,54 @@ portSTACK_TYPE *pxPortInitialiseStack(portSTACK_TYPE *pxTopOfStack,
 
     vPortEnterCritical();
 
-    lIndexOfLastAddedTask = prvGetFreeThreadState();
+    pxLastAddedThread = prvGetFreeThreadState();
+    if (NULL == pxLastAddedThread) {
+        vPortFree(pxThisThreadParams);
+        vPortExitCritical();
+        return 0;
+    }
+    pxThisThreadParams->pxThread = pxLastAddedThread;
+#if( configUSE_FUTEX_HANDOFF == 1 )
+    pxLastAddedThread->iRunning = 0;
+#endif
+
+    pxLastAddedThread->pxStack = prvTakeThreadStack();
+    if (NULL == pxLastAddedThread->pxStack) {
+        vPortFree(pxThisThreadParams);
+        vPortExitCritical();
+        return 0;
+    }
+    pthread_attr_setstack(&xThreadAttributes,
+                          pxLastAddedThread->pxStack->pvStack,
+                          configTHREAD_STACK_SIZE);
 
     /* Create the new pThread. */
     if (0 == pthread_mutex_lock(&xSingleThreadMutex)) {
         xSentinel = 0;
         if (0 !=
-            pthread_create(&(pxThreads[lIndexOfLastAddedTask].hThread),
+            pthread_create(&(pxLastAddedThread->hThread),
                            &xThreadAttributes, prvWaitForStart,
                            (void *)pxThisThreadParams)) {
             /* Thread create failed, signal the failure */
             pxTopOfStack = 0;
+            (void)pthread_mutex_lock(&xThreadStackMutex);
+            pxLastAddedThread->pxStack->pxNext = pxFreeStacks;
+            pxFreeStacks = pxLastAddedThread->pxStack;
+            (void)pthread_mutex_unlock(&xThreadStackMutex);
+        }
+        else {
+            /* The kernel keeps this as the task's top of stack, the port
+            never uses the stack itself. */
+            pxTopOfStack = (portSTACK_TYPE *)pxLastAddedThread;
         }
 
-        /* Wait until the task suspends. */
+        /* Wait until the task suspends.  Give the processor to the new
+        thread meanwhile, spinning would only hold it up until the time slice
+        ends. */
         (void)pthread_mutex_unlock(&xSingleThreadMutex);
-        while (xSentinel == 0)
-            ;
+        while (xSentinel == 0) {
+            sched_yield();
+        }
         vPortExitCritical();
     }
 
@@ -195,7 +309,7 @@ void vPortStartFirstTask(void)
     vPortEnableInterrupts();
 
     /* Start the first task. */
-    prvResumeThread(prvGetThreadHandle(xTaskGetCurrentTaskHandle()));
+    prvResumeThread(prvGetThreadState(xTaskGetCurrentTaskHandle()));
 }
 /*-----------------------------------------------------------*/
 
@@ -209,6 +323,8 @@ portBASE_TYPE xPortStartScheduler(void)
     sigset_t xSignals;
     sigset_t xSignalToBlock;
     sigset_t xSignalsBlocked;
+    struct timespec xNoWait = { 0, 0 };
+    xThreadStateBlock *pxBlock;
     portLONG lIndex;
 
     /* Establish the signals to block before they are needed. */
@@ -217,13 +333,24 @@ portBASE_TYPE xPortStartScheduler(void)
     /* Block until the end */
     (void)pthread_sigmask(SIG_SETMASK, &xSignalToBlock, &xSignalsBlocked);
 
-    for (lIndex = 0; lIndex < MAX_NUMBER_OF_TASKS; lIndex++) {
-        pxThreads[lIndex].uxCriticalNesting = 0;
+    for (pxBlock = pxThreadBlocks; NULL != pxBlock; pxBlock = pxBlock->pxNext) {
+        for (lIndex = 0; lIndex < THREAD_STATES_PER_BLOCK; lIndex++) {
+            pxBlock->xStates[lIndex].uxCriticalNesting = 0;
+        }
     }
 
     /* Start the timer that generates the tick ISR.  Interrupts are disabled
-    here already. */
+    here already.  In virtual time the idle task generates the ticks. */
+#if( configUSE_VIRTUAL_TIME == 0 )
+    ullPendingTicks = 0;
+    ullTicksProcessed = 0;
+    ullTicksDeferred = 0;
+    ullTickStartTime = prvGetTime();
+    ullTickEndTime = 0;
     prvSetupTimerInterrupt();
+#else
+    ullTicksProcessed = 0;
+#endif
 
     /* Start the first task. Will not return unless all threads are killed. */
     vPortStartFirstTask();
@@ -238,13 +365,36 @@ portBASE_TYPE xPortStartScheduler(void)
         }
     }
 
-    printf("Cleaning Up, Exiting.\n");
+    fprintf(stderr, "Cleaning Up, Exiting.\n");
+
+    /* Leave everything as before the first task was created, so the
+    scheduler can be started again after vTaskResetKernel(). */
+#if( configUSE_VIRTUAL_TIME == 0 )
+    prvStopTimerInterrupt();
+#endif
+    xThreadsEnded = prvResetThreadStates();
+
+    /* Ticks that came in meanwhile must not be handled on this thread. */
+    sigemptyset(&xSignals);
+    sigaddset(&xSignals, SIG_TICK);
+    sigaddset(&xSignals, SIG_RESUME);
+    while (0 < sigtimedwait(&xSignals, NULL, &xNoWait)) {
+    }
+    (void)pthread_sigmask(SIG_SETMASK, &xSignalsBlocked, NULL);
+
     /* Cleanup the mutexes */
     /** xResult = pthread_mutex_destroy( &xSuspendResumeThreadMutex ); */
     pthread_mutex_destroy(&xSuspendResumeThreadMutex);
+    pthread_mutex_init(&xSuspendResumeThreadMutex, NULL);
     /** xResult = pthread_mutex_destroy( &xSingleThreadMutex ); */
     pthread_mutex_destroy(&xSingleThreadMutex);
-    vPortFree((void *)pxThreads);
+    pthread_mutex_init(&xSingleThreadMutex, NULL);
+
+    xSchedulerEnd = pdFALSE;
+    xInterruptsEnabled = pdTRUE;
+    xServicingTick = pdFALSE;
+    xPendYield = pdFALSE;
+    uxCriticalNesting = 0;
 
     /* Should not get here! */
     return 0;
@@ -253,17 +403,22 @@ portBASE_TYPE xPortStartScheduler(void)
 
 void vPortEndScheduler(void)
 {
-    portBASE_TYPE xNumberOfThreads;
+    xThreadStateBlock *pxBlock;
+    portLONG lIndex;
     /** portBASE_TYPE xResult; */
-    for (xNumberOfThreads = 0; xNumberOfThreads < MAX_NUMBER_OF_TASKS;
-         xNumberOfThreads++) {
-        if ((pthread_t)NULL != pxThreads[xNumberOfThreads].hThread) {
-            /* Kill all of the threads, they are in the detached state. */
-            pthread_cancel(pxThreads[xNumberOfThreads].hThread);
-            /** xResult = pthread_cancel( pxThreads[ xNumberOfThreads ].hThread ); */
+    for (pxBlock = pxThreadBlocks; NULL != pxBlock; pxBlock = pxBlock->pxNext) {
+        for (lIndex = 0; lIndex < THREAD_STATES_PER_BLOCK; lIndex++) {
+            if ((pthread_t)NULL != pxBlock->xStates[lIndex].hThread) {
+                /* Kill all of the threads, they are in the detached state. */
+                prvCancelThread(&pxBlock->xStates[lIndex]);
+            }
         }
     }
 
+#if( configUSE_VIRTUAL_TIME == 0 )
+    ullTickEndTime = prvGetTime();
+#endif
+
     /* Signal the scheduler to exit its loop. */
     xSchedulerEnd = pdTRUE;
     (void)pthread_kill(hMainThread, SIG_RESUME);
@@ -302,33 +457,35 @@ void vPortExitCritical(void)
             vPortYield();
         }
         vPortEnableInterrupts();
+#if( configUSE_VIRTUAL_TIME == 0 )
+        /* Ticks came while the interrupts were disabled, take them now like
+        a pended interrupt instead of waiting for the next one. */
+        prvCatchUpTicks();
+#endif
     }
 }
 /*-----------------------------------------------------------*/
 
 void vPortYield(void)
 {
-    pthread_t xTaskToSuspend;
-    pthread_t xTaskToResume = 0;
+    xThreadState *pxTaskToSuspend;
+    xThreadState *pxTaskToResume;
 
     if (0 == pthread_mutex_lock(&xSingleThreadMutex)) {
-        xTaskToSuspend =
-            prvGetThreadHandle(xTaskGetCurrentTaskHandle());
+        pxTaskToSuspend =
+            prvGetThreadState(xTaskGetCurrentTaskHandle());
 
         vTaskSwitchContext();
 
-        TaskHandle_t task_handle = xTaskGetCurrentTaskHandle();
-        xTaskToResume = prvGetThreadHandle(task_handle);
-        /** xTaskToResume = prvGetThreadHandle( xTaskGetCurrentTaskHandle() ); */
-        if (xTaskToSuspend != xTaskToResume && xTaskToResume) {
+        pxTaskToResume = prvGetThreadState(xTaskGetCurrentTaskHandle());
+        if (pxTaskToSuspend != pxTaskToResume &&
+            (pthread_t)NULL != pxTaskToResume->hThread) {
             /* Remember and switch the critical nesting. */
-            prvSetTaskCriticalNesting(xTaskToSuspend,
-                                      uxCriticalNesting);
-            uxCriticalNesting =
-                prvGetTaskCriticalNesting(xTaskToResume);
+            pxTaskToSuspend->uxCriticalNesting = uxCriticalNesting;
+            uxCriticalNesting = pxTaskToResume->uxCriticalNesting;
             /* Switch tasks. */
-            prvResumeThread(xTaskToResume);
-            prvSuspendThread(xTaskToSuspend);
+            prvResumeThread(pxTaskToResume);
+            prvSuspendThread(pxTaskToSuspend);
         }
         else {
             /* Yielding to self */
@@ -364,6 +521,86 @@ void vPortClearInterruptMask(portBASE_TYPE xMask)
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_VIRTUAL_TIME == 0 )
+
+#if( configUSE_TICK_THREAD == 1 )
+
+/*
+ * Start the tick thread, it counts the expirations of a timerfd at the
+ * required frequency.
+ */
+void prvSetupTimerInterrupt(void)
+{
+    long lNanoSeconds = 1000000000L / configTICK_RATE_HZ;
+    struct itimerspec xTimer = { { lNanoSeconds / 1000000000L,
+                                   lNanoSeconds % 1000000000L },
+                                 { lNanoSeconds / 1000000000L,
+                                   lNanoSeconds % 1000000000L }
+                               };
+
+    iTickTimer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (0 > iTickTimer) {
+        printf("Create Timer problem.\n");
+        return;
+    }
+    if (0 != timerfd_settime(iTickTimer, 0, &xTimer, NULL)) {
+        printf("Set Timer problem.\n");
+    }
+
+    /* Called with all signals blocked, the tick thread keeps it that way. */
+    if (0 != pthread_create(&hTickThread, NULL, prvTickThread, NULL)) {
+        printf("Tick Thread problem.\n");
+        close(iTickTimer);
+        iTickTimer = -1;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void prvStopTimerInterrupt(void)
+{
+    if (0 > iTickTimer) {
+        return;
+    }
+
+    /* read() is a cancellation point. */
+    pthread_cancel(hTickThread);
+    pthread_join(hTickThread, NULL);
+    close(iTickTimer);
+    iTickTimer = -1;
+}
+/*-----------------------------------------------------------*/
+
+void *prvTickThread(void *pvParams)
+{
+    uint64_t ullExpirations;
+
+    (void)pvParams;
+
+    for (;;) {
+        /* The number of periods since the last read, more than one if this
+        thread was late.  Every one of them is a tick. */
+        if (sizeof(ullExpirations) !=
+            read(iTickTimer, &ullExpirations, sizeof(ullExpirations))) {
+            if (EINTR == errno) {
+                continue;
+            }
+            printf("Read Timer problem.\n");
+            break;
+        }
+
+        __atomic_add_fetch(&ullPendingTicks, ullExpirations, __ATOMIC_RELAXED);
+
+        /* Goes to the running task thread, the others block SIG_TICK.  The
+        signals may merge, the count does not. */
+        (void)kill(getpid(), SIG_TICK);
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+#else /* configUSE_TICK_THREAD */
+
 /*
  * Setup the systick timer to generate the tick interrupts at the required
  * frequency.
@@ -394,38 +631,129 @@ void prvSetupTimerInterrupt(void)
 }
 /*-----------------------------------------------------------*/
 
+void prvStopTimerInterrupt(void)
+{
+    struct itimerval itimer = { { 0, 0 }, { 0, 0 } };
+
+    if (0 != setitimer(TIMER_TYPE, &itimer, NULL)) {
+        printf("Stop Timer problem.\n");
+    }
+}
+
+#endif /* configUSE_TICK_THREAD */
+/*-----------------------------------------------------------*/
+
+uint64_t prvGetTime(void)
+{
+    struct timespec xNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &xNow);
+    return (uint64_t)xNow.tv_sec * 1000000000ULL + (uint64_t)xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Processes all pending ticks, called by the tick handler.  All but the
+ * newest one should have been processed earlier.
+ */
+void prvProcessPendingTicks(void)
+{
+    uint64_t ullTicks = __atomic_exchange_n(&ullPendingTicks, 0,
+                                            __ATOMIC_RELAXED);
+
+    if (0 == ullTicks) {
+        return;
+    }
+
+    __atomic_add_fetch(&ullTicksProcessed, ullTicks, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&ullTicksDeferred, ullTicks - 1, __ATOMIC_RELAXED);
+    while (ullTicks-- > 0) {
+        (void)xTaskIncrementTick();
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Processes the ticks that the tick handler had to leave pending, through
+ * the pended ticks of the kernel.  Called by the running task when it leaves
+ * its critical section.
+ */
+void prvCatchUpTicks(void)
+{
+    uint64_t ullTicks;
+
+    if ((0 == __atomic_load_n(&ullPendingTicks, __ATOMIC_RELAXED)) ||
+        (pdTRUE == xServicingTick) ||
+        (taskSCHEDULER_RUNNING != xTaskGetSchedulerState())) {
+        return;
+    }
+
+    ullTicks = __atomic_exchange_n(&ullPendingTicks, 0, __ATOMIC_RELAXED);
+    if (0 == ullTicks) {
+        return;
+    }
+
+    __atomic_add_fetch(&ullTicksProcessed, ullTicks, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&ullTicksDeferred, ullTicks, __ATOMIC_RELAXED);
+    (void)xTaskCatchUpTicks((TickType_t)ullTicks);
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_VIRTUAL_TIME */
+/*-----------------------------------------------------------*/
+
 void vPortSystemTickHandler(int sig)
 {
-    pthread_t xTaskToSuspend;
-    pthread_t xTaskToResume;
+    xThreadState *pxTaskToSuspend;
+    xThreadState *pxTaskToResume;
+
+#if( configUSE_VIRTUAL_TIME == 0 )
+#if( configUSE_TICK_THREAD == 0 )
+    /* Every signal of the timer is a tick. */
+    __atomic_add_fetch(&ullPendingTicks, 1, __ATOMIC_RELAXED);
+#endif
+    /* Merged signals, an earlier one has taken the ticks already. */
+    if (0 == __atomic_load_n(&ullPendingTicks, __ATOMIC_RELAXED)) {
+        return;
+    }
+#endif
 
     if ((pdTRUE == xInterruptsEnabled) && (pdTRUE != xServicingTick)) {
         if (0 == pthread_mutex_trylock(&xSingleThreadMutex)) {
             xServicingTick = pdTRUE;
 
-            xTaskToSuspend =
-                prvGetThreadHandle(xTaskGetCurrentTaskHandle());
+            pxTaskToSuspend =
+                prvGetThreadState(xTaskGetCurrentTaskHandle());
+#if( configUSE_VIRTUAL_TIME == 0 )
+            /* All ticks since the last one that was processed. */
+            prvProcessPendingTicks();
+#else
             /* Tick Increment. */
+            ullTicksProcessed++;
             xTaskIncrementTick();
+#endif
 
             /* Select Next Task. */
 #if (configUSE_PREEMPTION == 1)
             vTaskSwitchContext();
 #endif
-            xTaskToResume =
-                prvGetThreadHandle(xTaskGetCurrentTaskHandle());
+            pxTaskToResume =
+                prvGetThreadState(xTaskGetCurrentTaskHandle());
 
             /* The only thread that can process this tick is the running thread. */
-            if (xTaskToSuspend != xTaskToResume) {
+            if (pxTaskToSuspend != pxTaskToResume) {
                 /* Remember and switch the critical nesting. */
-                prvSetTaskCriticalNesting(xTaskToSuspend,
-                                          uxCriticalNesting);
-                uxCriticalNesting = prvGetTaskCriticalNesting(
-                                        xTaskToResume);
+                pxTaskToSuspend->uxCriticalNesting = uxCriticalNesting;
+                uxCriticalNesting = pxTaskToResume->uxCriticalNesting;
                 /* Resume next task. */
-                prvResumeThread(xTaskToResume);
+                prvResumeThread(pxTaskToResume);
+#if( configUSE_FUTEX_HANDOFF == 1 )
+                /* This thread parks inside the handler, the next tick is
+                processed by the thread that runs now. */
+                xServicingTick = pdFALSE;
+#endif
                 /* Suspend the current task. */
-                prvSuspendThread(xTaskToSuspend);
+                prvSuspendThread(pxTaskToSuspend);
             }
             else {
                 /* Release the lock as we are Resuming. */
@@ -443,22 +771,47 @@ void vPortSystemTickHandler(int sig)
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_VIRTUAL_TIME == 1 )
+
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+    /* Called by the idle task with the scheduler suspended, so nothing else
+    runs.  A task that was readied in the meantime gets the processor as soon
+    as the scheduler is resumed. */
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        return;
+    }
+
+    /* Nothing happens until the next task unblocks, skip the ticks up to
+    there.  The tick that unblocks it is pended, xTaskResumeAll() processes
+    it like a tick interrupt that occurred while the scheduler was
+    suspended and switches to the task. */
+    vTaskStepTick(xExpectedIdleTime - 1);
+    (void)xTaskIncrementTick();
+    ullTicksProcessed += xExpectedIdleTime;
+}
+
+#endif /* configUSE_VIRTUAL_TIME */
+/*-----------------------------------------------------------*/
+
 void vPortForciblyEndThread(void *pxTaskToDelete)
 {
     xTaskHandle hTaskToDelete = (xTaskHandle)pxTaskToDelete;
+    xThreadState *pxThreadToDelete;
+    xThreadState *pxThreadToResume;
     pthread_t xTaskToDelete;
-    pthread_t xTaskToResume;
     /** portBASE_TYPE xResult; */
 
     if (0 == pthread_mutex_lock(&xSingleThreadMutex)) {
-        xTaskToDelete = prvGetThreadHandle(hTaskToDelete);
-        xTaskToResume = prvGetThreadHandle(xTaskGetCurrentTaskHandle());
+        pxThreadToDelete = prvGetThreadState(hTaskToDelete);
+        pxThreadToResume = prvGetThreadState(xTaskGetCurrentTaskHandle());
+        xTaskToDelete = pxThreadToDelete->hThread;
 
-        if (xTaskToResume == xTaskToDelete) {
+        if (pxThreadToResume == pxThreadToDelete) {
             /* This is a suicidal thread, need to select a different task to run. */
             vTaskSwitchContext();
-            xTaskToResume =
-                prvGetThreadHandle(xTaskGetCurrentTaskHandle());
+            pxThreadToResume =
+                prvGetThreadState(xTaskGetCurrentTaskHandle());
         }
 
         if (pthread_self() != xTaskToDelete) {
@@ -466,15 +819,14 @@ void vPortForciblyEndThread(void *pxTaskToDelete)
             if (xTaskToDelete != (pthread_t)NULL) {
                 /* Send a signal to wake the task so that it definitely cancels. */
                 pthread_testcancel();
-                pthread_cancel(xTaskToDelete);
-                /** xResult = pthread_cancel( xTaskToDelete ); */
+                prvCancelThread(pxThreadToDelete);
                 /* Pthread Clean-up function will note the cancellation. */
             }
             (void)pthread_mutex_unlock(&xSingleThreadMutex);
         }
         else {
             /* Resume the other thread. */
-            prvResumeThread(xTaskToResume);
+            prvResumeThread(pxThreadToResume);
             /* Pthread Clean-up function will note the cancellation. */
             /* Release the execution. */
             uxCriticalNesting = 0;
@@ -492,12 +844,19 @@ void *prvWaitForStart(void *pvParams)
     xParams *pxParams = (xParams *)pvParams;
     pdTASK_CODE pvCode = pxParams->pxCode;
     void *pParams = pxParams->pvParams;
+    xThreadState *pxThread = pxParams->pxThread;
     vPortFree(pvParams);
 
-    pthread_cleanup_push(prvDeleteThread, (void *)pthread_self());
+    /* pthread_create() might not have stored the handle yet. */
+    pxThread->hThread = pthread_self();
+#if( configUSE_FUTEX_HANDOFF == 1 )
+    pxThisThread = pxThread;
+#endif
+
+    pthread_cleanup_push(prvDeleteThread, (void *)pxThread);
 
     if (0 == pthread_mutex_lock(&xSingleThreadMutex)) {
-        prvSuspendThread(pthread_self());
+        prvSuspendThread(pxThread);
     }
 
     pvCode(pParams);
@@ -507,6 +866,69 @@ void *prvWaitForStart(void *pvParams)
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_FUTEX_HANDOFF == 1 )
+
+void prvSuspendThread(xThreadState *pxThread)
+{
+    sigset_t xSignals, xSignalsBlocked;
+    int iRunning = 1;
+
+    /* Only ever called by the thread that gives up the processor, which owns
+    xSingleThreadMutex.  The thread to run next has been resumed already. */
+    (void)pxThread;
+
+    /* A tick must only be processed by the running thread, so keep it pending
+    until this thread runs again. */
+    sigemptyset(&xSignals);
+    sigaddset(&xSignals, SIG_TICK);
+    (void)pthread_sigmask(SIG_BLOCK, &xSignals, &xSignalsBlocked);
+
+    /* Unless prvCancelThread() got here first, the -1 it left must stay or
+    the thread would never wake up again to end. */
+    (void)__atomic_compare_exchange_n(&pxThisThread->iRunning, &iRunning, 0,
+                                      pdFALSE, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED);
+    xSentinel = 1;
+
+    /* Unlock the Single thread mutex to allow the resumed task to continue. */
+    if (0 != pthread_mutex_unlock(&xSingleThreadMutex)) {
+        printf("Releasing someone else's lock.\n");
+    }
+
+    /* Park until another thread hands the processor back.  The futex wait is
+    no cancellation point, prvCancelThread() wakes a cancelled thread so it
+    can end. */
+    while (0 == __atomic_load_n(&pxThisThread->iRunning, __ATOMIC_ACQUIRE)) {
+        (void)syscall(SYS_futex, &pxThisThread->iRunning,
+                      FUTEX_WAIT_PRIVATE, 0, NULL, NULL, 0);
+        pthread_testcancel();
+    }
+    pthread_testcancel();
+
+    /* Need to set the interrupts based on the task's critical nesting. */
+    if (uxCriticalNesting == 0) {
+        vPortEnableInterrupts();
+    }
+    else {
+        vPortDisableInterrupts();
+    }
+
+    (void)pthread_sigmask(SIG_SETMASK, &xSignalsBlocked, NULL);
+}
+/*-----------------------------------------------------------*/
+
+void prvResumeThread(xThreadState *pxThread)
+{
+    if (pthread_self() != pxThread->hThread) {
+        __atomic_store_n(&pxThread->iRunning, 1, __ATOMIC_RELEASE);
+        (void)syscall(SYS_futex, &pxThread->iRunning,
+                      FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+/*-----------------------------------------------------------*/
+
+#else /* configUSE_FUTEX_HANDOFF */
+
 void prvSuspendSignalHandler(int sig)
 {
     sigset_t xSignals;
@@ -537,14 +959,14 @@ void prvSuspendSignalHandler(int sig)
 }
 /*-----------------------------------------------------------*/
 
-void prvSuspendThread(pthread_t xThreadId)
+void prvSuspendThread(xThreadState *pxThread)
 {
     portBASE_TYPE xResult = pthread_mutex_lock(&xSuspendResumeThreadMutex);
     if (0 == xResult) {
         /* Set-up for the Suspend Signal handler? */
         xSentinel = 0;
         xResult = pthread_mutex_unlock(&xSuspendResumeThreadMutex);
-        xResult = pthread_kill(xThreadId, SIG_SUSPEND);
+        xResult = pthread_kill(pxThread->hThread, SIG_SUSPEND);
         while ((xSentinel == 0) && (pdTRUE != xServicingTick)) {
             sched_yield();
         }
@@ -561,12 +983,12 @@ void prvResumeSignalHandler(int sig)
 }
 /*-----------------------------------------------------------*/
 
-void prvResumeThread(pthread_t xThreadId)
+void prvResumeThread(xThreadState *pxThread)
 {
     /** portBASE_TYPE xResult; */
     if (0 == pthread_mutex_lock(&xSuspendResumeThreadMutex)) {
-        if (pthread_self() != xThreadId) {
-            pthread_kill(xThreadId, SIG_RESUME);
+        if (pthread_self() != pxThread->hThread) {
+            pthread_kill(pxThread->hThread, SIG_RESUME);
             /** xResult = pthread_kill( xThreadId, SIG_RESUME ); */
         }
         pthread_mutex_unlock(&xSuspendResumeThreadMutex);
@@ -575,6 +997,8 @@ void prvResumeThread(pthread_t xThreadId)
 }
 /*-----------------------------------------------------------*/
 
+#endif /* configUSE_FUTEX_HANDOFF */
+
 void prvSetupSignalsAndSchedulerPolicy(void)
 {
     /* The following code would allow for configuring the scheduling of this task as a Real-time task.
@@ -587,17 +1011,12 @@ void prvSetupSignalsAndSchedulerPolicy(void)
     iPolicy = SCHED_FIFO;
     iResult = pthread_setschedparam( pthread_self(), iPolicy, &iSchedulerPriority );        */
 
-    struct sigaction sigsuspendself, sigresume, sigtick;
-    portLONG lIndex;
-
-    pxThreads = (xThreadState *)pvPortMalloc(sizeof(xThreadState) *
-                MAX_NUMBER_OF_TASKS);
-    for (lIndex = 0; lIndex < MAX_NUMBER_OF_TASKS; lIndex++) {
-        pxThreads[lIndex].hThread = (pthread_t)NULL;
-        pxThreads[lIndex].hTask = (xTaskHandle)NULL;
-        pxThreads[lIndex].uxCriticalNesting = 0;
-    }
+#if( configUSE_FUTEX_HANDOFF == 0 )
+    struct sigaction sigsuspendself, sigresume;
+#endif
+    struct sigaction sigtick;
 
+#if( configUSE_FUTEX_HANDOFF == 0 )
     sigsuspendself.sa_flags = 0;
     sigsuspendself.sa_handler = prvSuspendSignalHandler;
     sigfillset(&sigsuspendself.sa_mask);
@@ -605,141 +1024,265 @@ void prvSetupSignalsAndSchedulerPolicy(void)
     sigresume.sa_flags = 0;
     sigresume.sa_handler = prvResumeSignalHandler;
     sigfillset(&sigresume.sa_mask);
+#endif
 
     sigtick.sa_flags = 0;
     sigtick.sa_handler = vPortSystemTickHandler;
     sigfillset(&sigtick.sa_mask);
 
+#if( configUSE_FUTEX_HANDOFF == 0 )
     if (0 != sigaction(SIG_SUSPEND, &sigsuspendself, NULL)) {
         printf("Problem installing SIG_SUSPEND_SELF\n");
     }
     if (0 != sigaction(SIG_RESUME, &sigresume, NULL)) {
         printf("Problem installing SIG_RESUME\n");
     }
+#endif
     if (0 != sigaction(SIG_TICK, &sigtick, NULL)) {
         printf("Problem installing SIG_TICK\n");
     }
-    printf("Running as PID: %d\n", getpid());
+    fprintf(stderr, "Running as PID: %d\n", getpid());
 }
 /*-----------------------------------------------------------*/
 
-pthread_t prvGetThreadHandle(xTaskHandle hTask)
+xThreadState *prvGetThreadState(xTaskHandle hTask)
 {
-    pthread_t hThread = (pthread_t)NULL;
-    portLONG lIndex;
-    for (lIndex = 0; lIndex < MAX_NUMBER_OF_TASKS; lIndex++) {
-        if (pxThreads[lIndex].hTask == hTask) {
-            hThread = pxThreads[lIndex].hThread;
-            break;
-        }
-    }
-    return hThread;
+    return *(xThreadState **)hTask;
 }
 /*-----------------------------------------------------------*/
 
-portLONG prvGetFreeThreadState(void)
+xThreadState *prvGetFreeThreadState(void)
 {
+    xThreadStateBlock *pxBlock;
     portLONG lIndex;
-    for (lIndex = 0; lIndex < MAX_NUMBER_OF_TASKS; lIndex++) {
-        if (pxThreads[lIndex].hThread == (pthread_t)NULL) {
-            break;
+
+    /* The tasks are mostly created in one go, hand out the states of the
+    newest block in order and only look for the states of deleted tasks when
+    it is used up. */
+    if (uxThreadStatesUsed < THREAD_STATES_PER_BLOCK) {
+        return &pxThreadBlocks->xStates[uxThreadStatesUsed++];
+    }
+
+    for (pxBlock = pxThreadBlocks; NULL != pxBlock; pxBlock = pxBlock->pxNext) {
+        for (lIndex = 0; lIndex < THREAD_STATES_PER_BLOCK; lIndex++) {
+            if (pxBlock->xStates[lIndex].hThread == (pthread_t)NULL) {
+                return &pxBlock->xStates[lIndex];
+            }
         }
     }
 
-    if (MAX_NUMBER_OF_TASKS == lIndex) {
-        printf("No more free threads, please increase the maximum.\n");
-        lIndex = 0;
-        vPortEndScheduler();
+    pxBlock = (xThreadStateBlock *)pvPortMalloc(sizeof(xThreadStateBlock));
+    if (NULL == pxBlock) {
+        printf("No more free threads, out of memory.\n");
+        return NULL;
     }
+    memset(pxBlock, 0, sizeof(xThreadStateBlock));
+    pxBlock->pxNext = pxThreadBlocks;
+    pxThreadBlocks = pxBlock;
+    uxThreadStatesUsed = 1;
 
-    return lIndex;
+    return &pxBlock->xStates[0];
 }
 /*-----------------------------------------------------------*/
 
-void prvSetTaskCriticalNesting(pthread_t xThreadId,
-                               unsigned portBASE_TYPE uxNesting)
+void prvDeleteThread(void *pvThread)
 {
-    portLONG lIndex;
-    for (lIndex = 0; lIndex < MAX_NUMBER_OF_TASKS; lIndex++) {
-        if (pxThreads[lIndex].hThread == xThreadId) {
-            pxThreads[lIndex].uxCriticalNesting = uxNesting;
-            break;
-        }
+    xThreadState *pxThread = (xThreadState *)pvThread;
+
+    pxThread->hTask = (xTaskHandle)NULL;
+    /* A task deleted in a critical section leaves the interrupts enabled.
+    Once the scheduler has ended they stay disabled, a tick would switch to
+    threads that are being cancelled. */
+    if ((pxThread->uxCriticalNesting > 0) &&
+        (taskSCHEDULER_NOT_STARTED != xTaskGetSchedulerState())) {
+        uxCriticalNesting = 0;
+        vPortEnableInterrupts();
     }
+    pxThread->uxCriticalNesting = 0;
+
+    /* Still running on the stack, it is joined before the stack is used
+    again. */
+    (void)pthread_mutex_lock(&xThreadStackMutex);
+    pxThread->pxStack->hThread = pthread_self();
+    pxThread->pxStack->pxNext = pxEndedStacks;
+    pxEndedStacks = pxThread->pxStack;
+    (void)pthread_mutex_unlock(&xThreadStackMutex);
+
+    /* Last, prvGetFreeThreadState() hands the state out again from here. */
+    pxThread->hThread = (pthread_t)NULL;
 }
 /*-----------------------------------------------------------*/
 
-unsigned portBASE_TYPE prvGetTaskCriticalNesting(pthread_t xThreadId)
+xThreadStack *prvTakeThreadStack(void)
 {
-    unsigned portBASE_TYPE uxNesting = 0;
-    portLONG lIndex;
-    for (lIndex = 0; lIndex < MAX_NUMBER_OF_TASKS; lIndex++) {
-        if (pxThreads[lIndex].hThread == xThreadId) {
-            uxNesting = pxThreads[lIndex].uxCriticalNesting;
-            break;
+    size_t xPage = (size_t)sysconf(_SC_PAGESIZE);
+    xThreadStack *pxStack;
+    char *pcMapping;
+
+    (void)pthread_mutex_lock(&xThreadStackMutex);
+    if (NULL == pxFreeStacks) {
+        prvJoinEndedThreads();
+    }
+    pxStack = pxFreeStacks;
+    if (NULL != pxStack) {
+        pxFreeStacks = pxStack->pxNext;
+    }
+    (void)pthread_mutex_unlock(&xThreadStackMutex);
+
+    if (NULL != pxStack) {
+        return pxStack;
+    }
+
+    /* The pool is empty, map a new stack.  Its pages are only backed by
+    memory once the thread touches them. */
+    pxStack = (xThreadStack *)malloc(sizeof(xThreadStack));
+    pcMapping = mmap(NULL, xPage + configTHREAD_STACK_SIZE,
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if ((NULL == pxStack) || (MAP_FAILED == pcMapping)) {
+        printf("No more thread stacks, out of memory.\n");
+        free(pxStack);
+        if (MAP_FAILED != pcMapping) {
+            munmap(pcMapping, xPage + configTHREAD_STACK_SIZE);
         }
+        return NULL;
     }
-    return uxNesting;
+    (void)mprotect(pcMapping, xPage, PROT_NONE);
+    pxStack->pvStack = pcMapping + xPage;
+
+    return pxStack;
 }
 /*-----------------------------------------------------------*/
 
-void prvDeleteThread(void *xThreadId)
+void prvJoinEndedThreads(void)
 {
-    portLONG lIndex;
-    for (lIndex = 0; lIndex < MAX_NUMBER_OF_TASKS; lIndex++) {
-        if (pxThreads[lIndex].hThread == (pthread_t)xThreadId) {
-            pxThreads[lIndex].hThread = (pthread_t)NULL;
-            pxThreads[lIndex].hTask = (xTaskHandle)NULL;
-            if (pxThreads[lIndex].uxCriticalNesting > 0) {
-                uxCriticalNesting = 0;
-                vPortEnableInterrupts();
-            }
-            pxThreads[lIndex].uxCriticalNesting = 0;
-            break;
-        }
+    xThreadStack *pxStack;
+
+    /* Called with xThreadStackMutex held.  The threads have left their
+    cleanup handlers already, so the joins do not wait long. */
+    while (NULL != pxEndedStacks) {
+        pxStack = pxEndedStacks;
+        pxEndedStacks = pxStack->pxNext;
+        (void)pthread_join(pxStack->hThread, NULL);
+        pxStack->pxNext = pxFreeStacks;
+        pxFreeStacks = pxStack;
     }
 }
 /*-----------------------------------------------------------*/
 
-void vPortAddTaskHandle(void *pxTaskHandle)
+void prvCancelThread(xThreadState *pxThread)
+{
+    pthread_cancel(pxThread->hThread);
+#if( configUSE_FUTEX_HANDOFF == 1 )
+    /* The futex wait is no cancellation point.  Wake the thread without
+    letting it run, it sees the cancellation when it stops waiting. */
+    __atomic_store_n(&pxThread->iRunning, -1, __ATOMIC_RELEASE);
+    (void)syscall(SYS_futex, &pxThread->iRunning, FUTEX_WAKE_PRIVATE, 1,
+                  NULL, NULL, 0);
+#endif
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t prvResetThreadStates(void)
 {
+    struct timespec xWait = { 0, 1000000 };
+    xThreadStateBlock *pxBlock;
     portLONG lIndex;
+    portLONG lTries;
+
+    /* The cancelled threads clear their states while they end, wait for
+    them.  The thread that ended the scheduler ends after it returns from its
+    task function. */
+    for (lTries = 0; lTries < 1000; lTries++) {
+        for (pxBlock = pxThreadBlocks; NULL != pxBlock; pxBlock = pxBlock->pxNext) {
+            for (lIndex = 0; lIndex < THREAD_STATES_PER_BLOCK; lIndex++) {
+                if ((pthread_t)NULL != pxBlock->xStates[lIndex].hThread) {
+                    break;
+                }
+            }
+            if (THREAD_STATES_PER_BLOCK != lIndex) {
+                break;
+            }
+        }
 
-    pxThreads[lIndexOfLastAddedTask].hTask = (xTaskHandle)pxTaskHandle;
-    for (lIndex = 0; lIndex < MAX_NUMBER_OF_TASKS; lIndex++) {
-        if (pxThreads[lIndex].hThread ==
-            pxThreads[lIndexOfLastAddedTask].hThread) {
-            if (pxThreads[lIndex].hTask !=
-                pxThreads[lIndexOfLastAddedTask].hTask) {
-                pxThreads[lIndex].hThread = (pthread_t)NULL;
-                pxThreads[lIndex].hTask = NULL;
-                pxThreads[lIndex].uxCriticalNesting = 0;
+        if (NULL == pxBlock) {
+            /* All threads ended, the next run starts with new states on the
+            same stacks. */
+            (void)pthread_mutex_lock(&xThreadStackMutex);
+            prvJoinEndedThreads();
+            (void)pthread_mutex_unlock(&xThreadStackMutex);
+            while (NULL != pxThreadBlocks) {
+                pxBlock = pxThreadBlocks;
+                pxThreadBlocks = pxBlock->pxNext;
+                vPortFree(pxBlock);
             }
+            uxThreadStatesUsed = THREAD_STATES_PER_BLOCK;
+            return pdTRUE;
         }
+
+        nanosleep(&xWait, NULL);
     }
+
+    /* A thread still uses its state, keep them all. */
+    printf("Threads did not end, keeping their states.\n");
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortThreadsEnded(void)
+{
+    return xThreadsEnded;
+}
+/*-----------------------------------------------------------*/
+
+void vPortAddTaskHandle(void *pxTaskHandle)
+{
+    /* Thread states are found through the TCB, a stale entry with a reused
+    pthread handle no longer matters. */
+    pxLastAddedThread->hTask = (xTaskHandle)pxTaskHandle;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetTickStats(xTickStats *pxStats)
+{
+#if( configUSE_VIRTUAL_TIME == 0 )
+    uint64_t ullEnd = ullTickEndTime ? ullTickEndTime : prvGetTime();
+    uint64_t ullDue = ullTickStartTime ? (ullEnd - ullTickStartTime) /
+                      (1000000000ULL / configTICK_RATE_HZ) : 0;
+    uint64_t ullSeen = __atomic_load_n(&ullTicksProcessed, __ATOMIC_RELAXED) +
+                       __atomic_load_n(&ullPendingTicks, __ATOMIC_RELAXED);
+
+    pxStats->ullProcessed = ullTicksProcessed;
+    pxStats->ullDeferred = ullTicksDeferred;
+    /* Ticks that never came, eg. SIG_TICK signals that were merged. */
+    pxStats->ullLost = ullDue > ullSeen ? ullDue - ullSeen : 0;
+#else
+    /* Every tick is stepped or incremented, none can be late. */
+    pxStats->ullProcessed = ullTicksProcessed;
+    pxStats->ullDeferred = 0;
+    pxStats->ullLost = 0;
+#endif
 }
 /*-----------------------------------------------------------*/
 
 void vPortFindTicksPerSecond(void)
 {
-    /* Needs to be reasonably high for accuracy. */
-    unsigned long ulTicksPerSecond = sysconf(_SC_CLK_TCK);
-    printf("Timer Resolution for Run TimeStats is %ld ticks per second.\n",
-           ulTicksPerSecond);
+    fprintf(stderr,
+            "Timer Resolution for Run TimeStats is %lu ticks per second.\n",
+            portRUN_TIME_COUNTER_HZ);
 }
 /*-----------------------------------------------------------*/
 
 unsigned long ulPortGetTimerValue(void)
 {
-    struct tms xTimes;
-    unsigned long ulTotalTime = times(&xTimes);
-    /* Return the application code times.
-     * The timer only increases when the application code is actually running
-     * which means that the total execution times should add up to 100%.
+    struct timespec xNow;
+    /* Return the time in microseconds.  The run time stats are read on every
+     * context switch, times() would sum up the CPU times of all task threads
+     * there, which costs as much as the switch itself with 1000 tasks.  Only
+     * one task thread runs at a time, so the wall time still adds up to 100%.
      */
-    return (unsigned long)xTimes.tms_utime;
-
-    /* Should check ulTotalTime for being clock_t max minus 1. */
-    (void)ulTotalTime;
+    clock_gettime(CLOCK_MONOTONIC, &xNow);
+    return (unsigned long)xNow.tv_sec * 1000000UL +
+           (unsigned long)xNow.tv_nsec / 1000UL;
 }
 /*-----------------------------------------------------------*/
@@ -159,6 +159,37 @@ extern void vPortForciblyEndThread(void *pxTaskToDelete);
 extern void vPortAddTaskHandle(void *pxTaskHandle);
 #define traceTASK_CREATE( pxNewTCB )            vPortAddTaskHandle( pxNewTCB )
 
+/* pdFALSE if threads of the last run did not end, they may still use their
+TCBs and thread states, so vTaskResetKernel() must not drop the heap. */
+extern BaseType_t xPortThreadsEnded(void);
+#define portHEAP_RESET_ALLOWED()                xPortThreadsEnded()
+
+/* With configUSE_FUTEX_HANDOFF set to 1 a context switch wakes the next
+thread through its futex and parks the current one on its own, instead of
+suspending and resuming the threads with SIG_SUSPEND and SIG_RESUME. */
+#ifndef configUSE_FUTEX_HANDOFF
+#define configUSE_FUTEX_HANDOFF 0
+#endif
+
+#if( ( configUSE_FUTEX_HANDOFF == 1 ) && !defined( __linux__ ) )
+#error configUSE_FUTEX_HANDOFF needs the futexes of Linux
+#endif
+
+/* The tasks run on the stacks of their threads, configTHREAD_STACK_SIZE bytes
+each.  xTaskCreate() only allocates a word for the stack it is asked for. */
+#define portTASK_STACK_DEPTH( usStackDepth )    ( 1 )
+
+#ifndef configTHREAD_STACK_SIZE
+#define configTHREAD_STACK_SIZE     ( 64 * 1024 )
+#endif
+
+/* How the tasks are switched, for printing. */
+#if( configUSE_FUTEX_HANDOFF == 1 )
+#define portCONTEXT_SWITCH          "futex"
+#else
+#define portCONTEXT_SWITCH          "signals"
+#endif
+
 /* Posix Signal definitions that can be changed or read as appropriate. */
 #define SIG_SUSPEND                 SIGUSR1
 #define SIG_RESUME                  SIGUSR2
@@ -173,7 +204,31 @@ extern void vPortAddTaskHandle(void *pxTaskHandle);
 #define SIG_TICK                    SIGPROF
 #define TIMER_TYPE                  ITIMER_PROF */
 
-/* Make use of times(man 2) to gather run-time statistics on the tasks. */
+/* In virtual time no timer is set up, the idle task skips the tick count
+straight to the next time a task unblocks, see configUSE_VIRTUAL_TIME. */
+#if( configUSE_VIRTUAL_TIME == 1 )
+extern void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )   vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#define portTICK_FROM_IDLE          1
+#else
+#define portTICK_FROM_IDLE          0
+#endif
+
+/* Ticks of the current or last run of the scheduler, for checking that the
+simulated time kept up with the wall time.  A tick is deferred if it could not
+be processed when it occurred and was caught up later, and lost if by the
+clock it occurred but was never processed.  All are 0 in virtual time. */
+typedef struct TICK_STATS {
+    uint64_t ullProcessed;
+    uint64_t ullDeferred;
+    uint64_t ullLost;
+} xTickStats;
+
+extern void vPortGetTickStats(xTickStats *pxStats);
+
+/* The run-time statistics count microseconds of CLOCK_MONOTONIC in both
+ports, see ulPortGetTimerValue(). */
+#define portRUN_TIME_COUNTER_HZ                     1000000UL
 extern void vPortFindTicksPerSecond(void);
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vPortFindTicksPerSecond()       /* Nothing to do because the timer is already present. */
 extern unsigned long ulPortGetTimerValue(void);
@@ -0,0 +1,400 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>!AND MODIFIED BY!<< the FreeRTOS exception.
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    1 tab == 4 spaces!
+*/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the single threaded
+ * Ucontext port.
+ *
+ * Every task is a ucontext that runs on the stack the kernel allocated for
+ * it, a context switch is a swapcontext() on the thread that started the
+ * scheduler.  There is no timer signal: the tick is processed when a task
+ * leaves its outermost critical section and the tick is due, and when the
+ * idle task runs, which sleeps until the next task unblocks.  With
+ * configUSE_VIRTUAL_TIME the tick only advances in the idle task, without
+ * sleeping.
+ *----------------------------------------------------------*/
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+/*-----------------------------------------------------------*/
+
+/* The tasks run on their FreeRTOS stacks, which therefore have to be big
+enough for the C library.  StackType_t is 4 bytes wide. */
+_Static_assert(configMINIMAL_STACK_SIZE >= 4096,
+               "configMINIMAL_STACK_SIZE must be at least 4096 for the Ucontext port");
+
+#define portNANOSECONDS_PER_TICK    ( 1000000000ULL / configTICK_RATE_HZ )
+/*-----------------------------------------------------------*/
+
+/* Context of a task, kept at the top of its stack.  pxTopOfStack, the first
+member of the TCB, points to it. */
+typedef struct TASK_CONTEXT {
+    ucontext_t xContext;
+    unsigned portBASE_TYPE uxCriticalNesting;
+    pdTASK_CODE pxCode;
+    void *pvParameters;
+} xTaskContext;
+/*-----------------------------------------------------------*/
+
+static ucontext_t xSchedulerContext;
+static volatile portBASE_TYPE xSchedulerRunning = pdFALSE;
+static volatile portBASE_TYPE xInterruptsEnabled = pdTRUE;
+static volatile portBASE_TYPE xServicingTick = pdFALSE;
+static volatile portBASE_TYPE xPendYield = pdFALSE;
+static volatile unsigned portBASE_TYPE uxCriticalNesting;
+
+/* Ticks processed since the scheduler started and when it started. */
+static uint64_t ullTicks = 0;
+#if( configUSE_VIRTUAL_TIME == 0 )
+static uint64_t ullStartTime = 0;
+
+/* See vPortGetTickStats(). */
+static uint64_t ullTicksDeferred = 0;
+static uint64_t ullEndTime = 0;
+#endif
+/*-----------------------------------------------------------*/
+
+static xTaskContext *prvGetTaskContext(TaskHandle_t xTask);
+static void prvStartTask(void);
+#if( configUSE_VIRTUAL_TIME == 0 )
+static uint64_t prvGetTime(void);
+static void prvProcessTicks(void);
+#endif
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+portSTACK_TYPE *pxPortInitialiseStack(portSTACK_TYPE *pxTopOfStack,
+                                      pdTASK_CODE pxCode, void *pvParameters)
+{
+    uintptr_t uxEnd = (uintptr_t)(pxTopOfStack + 1);
+    xTaskContext *pxContext;
+    char *pcBottom;
+
+    pxContext = (xTaskContext *)((uxEnd - sizeof(xTaskContext)) &
+                                 ~((uintptr_t)portBYTE_ALIGNMENT_MASK));
+
+    /* Only the top of the stack is known here.  makecontext() starts the
+    stack at ss_sp + ss_size, so the guaranteed minimal size is given. */
+    pcBottom = (char *)uxEnd - configMINIMAL_STACK_SIZE * sizeof(StackType_t);
+
+    if (0 != getcontext(&pxContext->xContext)) {
+        printf("Get Context problem.\n");
+    }
+    pxContext->xContext.uc_stack.ss_sp = pcBottom;
+    pxContext->xContext.uc_stack.ss_size = (size_t)((char *)pxContext - pcBottom);
+    pxContext->xContext.uc_link = NULL;
+    pxContext->uxCriticalNesting = 0;
+    pxContext->pxCode = pxCode;
+    pxContext->pvParameters = pvParameters;
+    makecontext(&pxContext->xContext, prvStartTask, 0);
+
+    return (portSTACK_TYPE *)pxContext;
+}
+/*-----------------------------------------------------------*/
+
+xTaskContext *prvGetTaskContext(TaskHandle_t xTask)
+{
+    return *(xTaskContext **)xTask;
+}
+/*-----------------------------------------------------------*/
+
+void prvStartTask(void)
+{
+    xTaskContext *pxContext = prvGetTaskContext(xTaskGetCurrentTaskHandle());
+
+    /* A new task starts outside of any critical section. */
+    uxCriticalNesting = 0;
+    vPortEnableInterrupts();
+
+    pxContext->pxCode(pxContext->pvParameters);
+
+    /* Tasks must not return, end it as if it had deleted itself. */
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+portBASE_TYPE xPortStartScheduler(void)
+{
+    xTaskContext *pxFirst = prvGetTaskContext(xTaskGetCurrentTaskHandle());
+
+    ullTicks = 0;
+#if( configUSE_VIRTUAL_TIME == 0 )
+    ullTicksDeferred = 0;
+    ullEndTime = 0;
+    ullStartTime = prvGetTime();
+#endif
+    xSchedulerRunning = pdTRUE;
+
+    /* Start the first task.  Returns here when vPortEndScheduler() is
+    called. */
+    if (0 != swapcontext(&xSchedulerContext, &pxFirst->xContext)) {
+        printf("Start First Task problem.\n");
+    }
+
+    fprintf(stderr, "Cleaning Up, Exiting.\n");
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler(void)
+{
+#if( configUSE_VIRTUAL_TIME == 0 )
+    ullEndTime = prvGetTime();
+#endif
+    xSchedulerRunning = pdFALSE;
+    xServicingTick = pdFALSE;
+    xPendYield = pdFALSE;
+    uxCriticalNesting = 0;
+    vPortEnableInterrupts();
+
+    /* Return to xPortStartScheduler(), the tasks are never resumed. */
+    (void)setcontext(&xSchedulerContext);
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR(void)
+{
+    /* The tick is the only interrupt, it is processed with interrupts
+    disabled.  Yield as soon as they are enabled again. */
+    xPendYield = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical(void)
+{
+    vPortDisableInterrupts();
+    uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical(void)
+{
+    /* Check for unmatched exits. */
+    if (uxCriticalNesting > 0) {
+        uxCriticalNesting--;
+    }
+
+    /* If we have reached 0 then re-enable the interrupts. */
+    if (uxCriticalNesting == 0) {
+#if( configUSE_VIRTUAL_TIME == 0 )
+        /* Process the ticks that came due while the interrupts were
+        disabled. */
+        prvProcessTicks();
+#endif
+        if (pdTRUE == xPendYield) {
+            xPendYield = pdFALSE;
+            vPortYield();
+        }
+        vPortEnableInterrupts();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield(void)
+{
+    xTaskContext *pxFrom = prvGetTaskContext(xTaskGetCurrentTaskHandle());
+    xTaskContext *pxTo;
+
+    /* Remember the critical nesting, it is part of the task context. */
+    pxFrom->uxCriticalNesting = uxCriticalNesting;
+
+    vTaskSwitchContext();
+
+    pxTo = prvGetTaskContext(xTaskGetCurrentTaskHandle());
+    if (pxFrom != pxTo) {
+        if (0 != swapcontext(&pxFrom->xContext, &pxTo->xContext)) {
+            printf("Swap Context problem.\n");
+        }
+    }
+
+    /* Resumed, need to set the interrupts based on the task's critical
+    nesting. */
+    uxCriticalNesting = pxFrom->uxCriticalNesting;
+    if (uxCriticalNesting == 0) {
+        vPortEnableInterrupts();
+    }
+    else {
+        vPortDisableInterrupts();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts(void)
+{
+    xInterruptsEnabled = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts(void)
+{
+    xInterruptsEnabled = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xPortSetInterruptMask(void)
+{
+    portBASE_TYPE xReturn = xInterruptsEnabled;
+    xInterruptsEnabled = pdFALSE;
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask(portBASE_TYPE xMask)
+{
+    xInterruptsEnabled = xMask;
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_VIRTUAL_TIME == 0 )
+
+uint64_t prvGetTime(void)
+{
+    struct timespec xNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &xNow);
+    return (uint64_t)xNow.tv_sec * 1000000000ULL + (uint64_t)xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+void prvProcessTicks(void)
+{
+    uint64_t ullDue;
+    portBASE_TYPE xMask;
+
+    if ((pdTRUE != xSchedulerRunning) || (pdTRUE == xServicingTick)) {
+        return;
+    }
+
+    ullDue = (prvGetTime() - ullStartTime) / portNANOSECONDS_PER_TICK;
+    if (ullTicks >= ullDue) {
+        return;
+    }
+
+    /* Like the tick interrupt, with the interrupts disabled.  Ticks that
+    were missed because a task ran for longer are caught up. */
+    xServicingTick = pdTRUE;
+    xMask = xPortSetInterruptMask();
+    ullTicksDeferred += ullDue - ullTicks - 1;
+    while (ullTicks < ullDue) {
+        ullTicks++;
+        if (xTaskIncrementTick() != pdFALSE) {
+#if (configUSE_PREEMPTION == 1)
+            xPendYield = pdTRUE;
+#endif
+        }
+    }
+    vPortClearInterruptMask(xMask);
+    xServicingTick = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_VIRTUAL_TIME */
+
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+    /* Called by the idle task with the scheduler suspended.  A task that was
+    readied in the meantime gets the processor as soon as the scheduler is
+    resumed. */
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        return;
+    }
+
+#if( configUSE_VIRTUAL_TIME == 0 )
+    {
+        uint64_t ullWake = ullStartTime +
+                           (ullTicks + xExpectedIdleTime) *
+                           portNANOSECONDS_PER_TICK;
+        struct timespec xWake = { .tv_sec = ullWake / 1000000000ULL,
+                                  .tv_nsec = ullWake % 1000000000ULL
+                                };
+
+        /* Nothing can happen before the next task unblocks. */
+        while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+                                        &xWake, NULL)) {
+        }
+    }
+#endif
+
+    /* Skip the ticks up to the next task unblocking.  The tick that unblocks
+    it is pended, xTaskResumeAll() processes it and switches to the task. */
+    vTaskStepTick(xExpectedIdleTime - 1);
+    ullTicks += xExpectedIdleTime - 1;
+
+#if( configUSE_VIRTUAL_TIME == 0 )
+    prvProcessTicks();
+#else
+    ullTicks++;
+    (void)xTaskIncrementTick();
+#endif
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetTickStats(xTickStats *pxStats)
+{
+#if( configUSE_VIRTUAL_TIME == 0 )
+    uint64_t ullEnd = ullEndTime ? ullEndTime : prvGetTime();
+    uint64_t ullDue = ullStartTime ? (ullEnd - ullStartTime) /
+                      portNANOSECONDS_PER_TICK : 0;
+
+    pxStats->ullProcessed = ullTicks;
+    pxStats->ullDeferred = ullTicksDeferred;
+    /* The ticks are caught up whenever a task leaves a critical section, only
+    the ones after the last time are left. */
+    pxStats->ullLost = ullDue > ullTicks ? ullDue - ullTicks : 0;
+#else
+    /* Every tick is stepped or incremented, none can be late. */
+    pxStats->ullProcessed = ullTicks;
+    pxStats->ullDeferred = 0;
+    pxStats->ullLost = 0;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+void vPortFindTicksPerSecond(void)
+{
+    fprintf(stderr,
+            "Timer Resolution for Run TimeStats is %lu ticks per second.\n",
+            portRUN_TIME_COUNTER_HZ);
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulPortGetTimerValue(void)
+{
+    struct timespec xNow;
+    /* Return the time in microseconds, like the Posix port.  All tasks run on
+     * this thread, so the wall time adds up to 100% as the process CPU time
+     * of times() did, and the counts of both ports can be compared.
+     */
+    clock_gettime(CLOCK_MONOTONIC, &xNow);
+    return (unsigned long)xNow.tv_sec * 1000000UL +
+           (unsigned long)xNow.tv_nsec / 1000UL;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,156 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>!AND MODIFIED BY!<< the FreeRTOS exception.
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Single threaded port for GCC on Posix hosts.  All tasks are user level
+ * contexts (ucontext) that run on the thread that started the scheduler, the
+ * ticks are processed synchronously when a task leaves a critical section or
+ * the idle task finds nothing to do.
+ * */
+
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Port specific definitions.
+ *
+ * The settings in this file configure FreeRTOS correctly for the
+ * given hardware and compiler.
+ *
+ * These settings should not be altered.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions. Legacy*/
+#define portCHAR        char
+#define portFLOAT       float
+#define portDOUBLE      double
+#define portLONG        int
+#define portSHORT       short
+#define portSTACK_TYPE uint32_t
+#define portBASE_TYPE   long
+
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if( configUSE_16_BIT_TICKS == 1 )
+typedef uint16_t TickType_t;
+#define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+typedef uint32_t TickType_t;
+#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+
+/* Only one thread runs the tasks, so reads of the tick count do not need to be
+guarded with a critical section. */
+#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH                ( -1 )
+#define portTICK_PERIOD_MS              ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portTICK_PERIOD_MICROSECONDS        ( ( TickType_t ) 1000000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT              16
+#define portPOINTER_SIZE_TYPE           uintptr_t
+/*-----------------------------------------------------------*/
+
+
+/* Scheduler utilities. */
+extern void vPortYieldFromISR(void);
+extern void vPortYield(void);
+
+#define portYIELD()                 vPortYield()
+
+#define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired ) vPortYieldFromISR()
+#define portYIELD_FROM_ISR( xSwitchRequired ) portEND_SWITCHING_ISR( xSwitchRequired )
+/*-----------------------------------------------------------*/
+
+
+/* Critical section management.  There are no interrupts, the mask only
+defers the processing of the tick. */
+extern void vPortDisableInterrupts(void);
+extern void vPortEnableInterrupts(void);
+#define portSET_INTERRUPT_MASK()    ( vPortDisableInterrupts() )
+#define portCLEAR_INTERRUPT_MASK()  ( vPortEnableInterrupts() )
+
+extern BaseType_t xPortSetInterruptMask(void);
+extern void vPortClearInterruptMask(BaseType_t xMask);
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()       xPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)    vPortClearInterruptMask(x)
+
+
+extern void vPortEnterCritical(void);
+extern void vPortExitCritical(void);
+
+#define portDISABLE_INTERRUPTS()    portSET_INTERRUPT_MASK()
+#define portENABLE_INTERRUPTS()     portCLEAR_INTERRUPT_MASK()
+#define portENTER_CRITICAL()        vPortEnterCritical()
+#define portEXIT_CRITICAL()         vPortExitCritical()
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#define portNOP()
+
+#define portOUTPUT_BYTE( a, b )
+
+/* The idle task waits for the next tick, or with configUSE_VIRTUAL_TIME skips
+straight to it, and processes it. */
+extern void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )   vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#define portTICK_FROM_IDLE          1
+
+/* How the tasks are switched, for printing. */
+#define portCONTEXT_SWITCH          "ucontext"
+
+/* Ticks of the current or last run of the scheduler, for checking that the
+simulated time kept up with the wall time.  A tick is deferred if it could not
+be processed when it occurred and was caught up later, and lost if by the
+clock it occurred but was never processed.  All are 0 in virtual time. */
+typedef struct TICK_STATS {
+    uint64_t ullProcessed;
+    uint64_t ullDeferred;
+    uint64_t ullLost;
+} xTickStats;
+
+extern void vPortGetTickStats(xTickStats *pxStats);
+
+/* The run-time statistics count microseconds of CLOCK_MONOTONIC in both
+ports, see ulPortGetTimerValue(). */
+#define portRUN_TIME_COUNTER_HZ                     1000000UL
+extern void vPortFindTicksPerSecond(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vPortFindTicksPerSecond()       /* Nothing to do because the timer is already present. */
+extern unsigned long ulPortGetTimerValue(void);
+#define portGET_RUN_TIME_COUNTER_VALUE()            ulPortGetTimerValue()           /* Query the System time stats for this process. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
@@ -75,6 +75,9 @@ task.h is included from an application file. */
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+/* heap_slab.c replaces this file if configUSE_SLAB_HEAP is set to 1. */
+#if( configUSE_SLAB_HEAP == 0 )
+
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc(size_t xWantedSize)
@@ -111,5 +114,4 @@ void vPortFree(void *pv)
     }
 }
 
-
-
+#endif /* configUSE_SLAB_HEAP */
@@ -0,0 +1,374 @@
+/*
+ * Implementation of pvPortMalloc() and vPortFree() that serves the kernel
+ * objects from size-class slab pools and everything else from the compilers
+ * own malloc() and free() implementations.
+ *
+ * Used instead of heap_3.c if configUSE_SLAB_HEAP is set to 1.
+ *
+ * There is a size class for each of TCB_t, Queue_t and Timer_t, sized by the
+ * StaticTask_t, StaticQueue_t and StaticTimer_t mirrors of them, plus power of
+ * two classes from 32 bytes to 1 MiB for the other blocks, e.g. the one word
+ * stacks of the Posix port, the thread parameters or the stacks of the
+ * Ucontext port.  Every class owns a region of address space that is reserved
+ * once with mmap() and only backed by memory where blocks have been handed
+ * out.  A block is either taken from the free list of its class or carved from
+ * the untouched rest of the region, and a freed block is pushed onto the free
+ * list again, so both are O(1) and free of locks.  The free lists store block
+ * indices next to a tag that changes on every update, which rules out the ABA
+ * problem of a plain lock-free stack, and the regions are never unmapped, so
+ * reading the link of a block that another thread has just taken is harmless.
+ *
+ * Larger blocks, and blocks of a class whose region is used up, come from
+ * malloc(), which is thread safe, so neither path suspends the scheduler.
+ *
+ * All blocks of the classes together are the arena of a simulation run.
+ * xPortResetHeap() drops it at once by emptying the free lists and starting
+ * to carve every region from its beginning again, see vTaskResetKernel().
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_SLAB_HEAP == 1 )
+
+/* Blocks are aligned like the ones malloc() returns. */
+#define heapSLAB_ALIGNMENT          ( ( size_t ) 16 )
+#define heapSLAB_ROUND_UP( xSize )  ( ( ( xSize ) + heapSLAB_ALIGNMENT - 1 ) & ~( heapSLAB_ALIGNMENT - 1 ) )
+
+/* Address space reserved per class.  Only the pages blocks were carved from
+are backed by memory, the reservation merely has to be large enough for big
+tasksets, 4 GiB hold 16384 stacks of 256 KiB. */
+#define heapSLAB_REGION_SIZE        ( ( size_t ) 4 * 1024 * 1024 * 1024 )
+
+/* Up to this size the classes are looked up in a table, above it they are
+the powers of two up to heapSLAB_MAX_BLOCK_SIZE. */
+#define heapSLAB_SMALL_BLOCK_SIZE   ( ( size_t ) 1024 )
+#define heapSLAB_MAX_BLOCK_SIZE     ( ( size_t ) 1024 * 1024 )
+#define heapSLAB_LARGE_CLASSES      ( 10 )
+
+#define heapSLAB_NO_BLOCK           ( ( uint32_t ) 0 )
+#define heapSLAB_UNINITIALISED      0
+#define heapSLAB_INITIALISING       1
+#define heapSLAB_INITIALISED        2
+
+typedef struct SLAB_CLASS {
+    size_t xBlockSize;
+    size_t xBlocksPerRegion;
+    uint8_t *pucRegion;
+    /* Index + 1 of the first free block in the low half, heapSLAB_NO_BLOCK if
+    the list is empty, and the tag in the high half. */
+    uint64_t ullFreeList;
+    /* Blocks carved from the region so far. */
+    size_t xCarved;
+    size_t xInUse;
+    uint64_t ullAllocations;
+    uint64_t ullRequestedBytes;
+    uint64_t ullOverflows;
+} xSlabClass;
+
+/* The candidate sizes of the small classes, sorted and merged when the heap
+is set up.  Kernel objects larger than heapSLAB_SMALL_BLOCK_SIZE share the
+power of two classes. */
+static const size_t xSlabSizes[] = {
+    32, 64, 128, 256, 512, heapSLAB_SMALL_BLOCK_SIZE,
+    heapSLAB_ROUND_UP( sizeof( StaticTask_t ) ),
+    heapSLAB_ROUND_UP( sizeof( StaticQueue_t ) ),
+    heapSLAB_ROUND_UP( sizeof( StaticTimer_t ) )
+};
+
+#define heapSLAB_SMALL_CLASSES      ( sizeof( xSlabSizes ) / sizeof( xSlabSizes[ 0 ] ) )
+#define heapSLAB_MAX_CLASSES        ( heapSLAB_SMALL_CLASSES + heapSLAB_LARGE_CLASSES )
+
+static xSlabClass xSlabClasses[ heapSLAB_MAX_CLASSES ];
+static UBaseType_t uxSlabClassCount = 0;
+
+/* Smallest class for every multiple of heapSLAB_ALIGNMENT up to
+heapSLAB_SMALL_BLOCK_SIZE, so finding the class is a table lookup. */
+static uint8_t ucSlabClassOfSize[ ( heapSLAB_SMALL_BLOCK_SIZE / heapSLAB_ALIGNMENT ) + 1 ];
+
+/* The class of 2 KiB, the first power of two class after the table. */
+static UBaseType_t uxSlabFirstLargeClass = 0;
+
+/* All regions in one reservation, to tell slab blocks from malloc() blocks. */
+static uint8_t *pucSlabBase = NULL;
+static uint8_t *pucSlabEnd = NULL;
+
+static int iSlabState = heapSLAB_UNINITIALISED;
+
+/* Blocks that came from malloc(). */
+static size_t xLargeInUse = 0;
+static uint64_t ullLargeAllocations = 0;
+static uint64_t ullLargeRequestedBytes = 0;
+
+/*-----------------------------------------------------------*/
+
+static void prvSlabInitialise(void)
+{
+    size_t xSizes[ heapSLAB_MAX_CLASSES ];
+    UBaseType_t uxClass, uxOther;
+    size_t xSize, xSlot;
+
+    /* Sort the candidate sizes and drop duplicates. */
+    for (uxClass = 0; uxClass < heapSLAB_SMALL_CLASSES; uxClass++) {
+        xSize = xSlabSizes[ uxClass ];
+        if (xSize > heapSLAB_SMALL_BLOCK_SIZE) {
+            xSize = heapSLAB_SMALL_BLOCK_SIZE;
+        }
+        for (uxOther = uxClass; uxOther > 0 && xSizes[ uxOther - 1 ] > xSize; uxOther--) {
+            xSizes[ uxOther ] = xSizes[ uxOther - 1 ];
+        }
+        xSizes[ uxOther ] = xSize;
+    }
+
+    pucSlabBase = mmap(NULL, heapSLAB_MAX_CLASSES * heapSLAB_REGION_SIZE,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (pucSlabBase == MAP_FAILED) {
+        /* Everything is served by malloc(). */
+        pucSlabBase = NULL;
+        return;
+    }
+
+    for (uxClass = 0; uxClass < heapSLAB_MAX_CLASSES; uxClass++) {
+        if (uxClass >= heapSLAB_SMALL_CLASSES) {
+            if (uxSlabFirstLargeClass == 0) {
+                uxSlabFirstLargeClass = uxSlabClassCount;
+            }
+            xSizes[ uxClass ] = heapSLAB_SMALL_BLOCK_SIZE << (uxClass - heapSLAB_SMALL_CLASSES + 1);
+        }
+        else if (uxSlabClassCount > 0 &&
+            xSlabClasses[ uxSlabClassCount - 1 ].xBlockSize == xSizes[ uxClass ]) {
+            continue;
+        }
+
+        xSlabClass *pxClass = &xSlabClasses[ uxSlabClassCount ];
+        pxClass->xBlockSize = xSizes[ uxClass ];
+        pxClass->xBlocksPerRegion = heapSLAB_REGION_SIZE / pxClass->xBlockSize;
+        pxClass->pucRegion = pucSlabBase + uxSlabClassCount * heapSLAB_REGION_SIZE;
+        uxSlabClassCount++;
+    }
+    pucSlabEnd = pucSlabBase + uxSlabClassCount * heapSLAB_REGION_SIZE;
+
+    uxClass = 0;
+    for (xSlot = 0; xSlot <= heapSLAB_SMALL_BLOCK_SIZE / heapSLAB_ALIGNMENT; xSlot++) {
+        while (xSlabClasses[ uxClass ].xBlockSize < xSlot * heapSLAB_ALIGNMENT) {
+            uxClass++;
+        }
+        ucSlabClassOfSize[ xSlot ] = (uint8_t) uxClass;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSlabInitialiseOnce(void)
+{
+    int iState = __atomic_load_n(&iSlabState, __ATOMIC_ACQUIRE);
+
+    if (iState == heapSLAB_INITIALISED) {
+        return;
+    }
+
+    iState = heapSLAB_UNINITIALISED;
+    if (__atomic_compare_exchange_n(&iSlabState, &iState, heapSLAB_INITIALISING,
+                                    pdFALSE, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        prvSlabInitialise();
+        __atomic_store_n(&iSlabState, heapSLAB_INITIALISED, __ATOMIC_RELEASE);
+        return;
+    }
+
+    /* Another thread is setting the heap up. */
+    while (__atomic_load_n(&iSlabState, __ATOMIC_ACQUIRE) != heapSLAB_INITIALISED) {
+        sched_yield();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void *prvSlabTake(xSlabClass *pxClass)
+{
+    uint64_t ullHead, ullNewHead;
+    uint32_t ulIndex, ulNext;
+    size_t xCarved;
+
+    ullHead = __atomic_load_n(&pxClass->ullFreeList, __ATOMIC_ACQUIRE);
+    while ((ulIndex = (uint32_t) ullHead) != heapSLAB_NO_BLOCK) {
+        /* The block might be taken by another thread meanwhile, then the link
+        is stale but the tag makes the exchange fail. */
+        ulNext = __atomic_load_n((uint32_t *)(pxClass->pucRegion + (ulIndex - 1) * pxClass->xBlockSize),
+                                 __ATOMIC_RELAXED);
+        ullNewHead = ((ullHead & 0xFFFFFFFF00000000ULL) + 0x100000000ULL) | ulNext;
+        if (__atomic_compare_exchange_n(&pxClass->ullFreeList, &ullHead, ullNewHead,
+                                        pdTRUE, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            return pxClass->pucRegion + (ulIndex - 1) * pxClass->xBlockSize;
+        }
+    }
+
+    xCarved = __atomic_load_n(&pxClass->xCarved, __ATOMIC_RELAXED);
+    do {
+        if (xCarved >= pxClass->xBlocksPerRegion) {
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&pxClass->xCarved, &xCarved, xCarved + 1,
+                                          pdTRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    return pxClass->pucRegion + xCarved * pxClass->xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSlabGive(xSlabClass *pxClass, uint8_t *pucBlock)
+{
+    uint32_t ulIndex = (uint32_t)((pucBlock - pxClass->pucRegion) / pxClass->xBlockSize) + 1;
+    uint64_t ullHead, ullNewHead;
+
+    ullHead = __atomic_load_n(&pxClass->ullFreeList, __ATOMIC_RELAXED);
+    do {
+        __atomic_store_n((uint32_t *) pucBlock, (uint32_t) ullHead, __ATOMIC_RELAXED);
+        ullNewHead = ((ullHead & 0xFFFFFFFF00000000ULL) + 0x100000000ULL) | ulIndex;
+    } while (!__atomic_compare_exchange_n(&pxClass->ullFreeList, &ullHead, ullNewHead,
+                                          pdTRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+/*-----------------------------------------------------------*/
+
+static xSlabClass *prvSlabClassOf(size_t xWantedSize)
+{
+    if (xWantedSize <= heapSLAB_SMALL_BLOCK_SIZE) {
+        return &xSlabClasses[ ucSlabClassOfSize[ (xWantedSize + heapSLAB_ALIGNMENT - 1) / heapSLAB_ALIGNMENT ] ];
+    }
+
+    /* The power of two the size is rounded up to, 2 KiB is the first. */
+    return &xSlabClasses[ uxSlabFirstLargeClass + (64 - __builtin_clzll(xWantedSize - 1)) - 11 ];
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+    void *pvReturn = NULL;
+
+    prvSlabInitialiseOnce();
+
+    if (pucSlabBase != NULL && xWantedSize <= heapSLAB_MAX_BLOCK_SIZE) {
+        xSlabClass *pxClass = prvSlabClassOf(xWantedSize);
+
+        pvReturn = prvSlabTake(pxClass);
+        if (pvReturn != NULL) {
+            __atomic_add_fetch(&pxClass->xInUse, 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&pxClass->ullAllocations, 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&pxClass->ullRequestedBytes, xWantedSize, __ATOMIC_RELAXED);
+            return pvReturn;
+        }
+
+        __atomic_add_fetch(&pxClass->ullOverflows, 1, __ATOMIC_RELAXED);
+    }
+
+    pvReturn = malloc(xWantedSize);
+    if (pvReturn != NULL) {
+        __atomic_add_fetch(&xLargeInUse, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&ullLargeAllocations, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&ullLargeRequestedBytes, xWantedSize, __ATOMIC_RELAXED);
+    }
+
+#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+    {
+        if (pvReturn == NULL) {
+            extern void vApplicationMallocFailedHook(void);
+            vApplicationMallocFailedHook();
+        }
+    }
+#endif
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree(void *pv)
+{
+    uint8_t *pucBlock = (uint8_t *) pv;
+
+    if (pucBlock == NULL) {
+        return;
+    }
+
+    if (pucBlock >= pucSlabBase && pucBlock < pucSlabEnd) {
+        xSlabClass *pxClass = &xSlabClasses[ (size_t)(pucBlock - pucSlabBase) / heapSLAB_REGION_SIZE ];
+
+        prvSlabGive(pxClass, pucBlock);
+        __atomic_sub_fetch(&pxClass->xInUse, 1, __ATOMIC_RELAXED);
+    } else {
+        free(pv);
+        __atomic_sub_fetch(&xLargeInUse, 1, __ATOMIC_RELAXED);
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortResetHeap(void)
+{
+    UBaseType_t uxClass;
+
+    prvSlabInitialiseOnce();
+
+    /* Blocks that came from malloc() have to be freed one by one. */
+    if (pucSlabBase == NULL || __atomic_load_n(&xLargeInUse, __ATOMIC_ACQUIRE) != 0) {
+        return pdFALSE;
+    }
+
+    for (uxClass = 0; uxClass < uxSlabClassCount; uxClass++) {
+        xSlabClass *pxClass = &xSlabClasses[ uxClass ];
+
+        __atomic_store_n(&pxClass->ullFreeList, heapSLAB_NO_BLOCK, __ATOMIC_RELAXED);
+        __atomic_store_n(&pxClass->xCarved, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&pxClass->xInUse, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&pxClass->ullAllocations, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&pxClass->ullRequestedBytes, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&pxClass->ullOverflows, 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&ullLargeAllocations, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ullLargeRequestedBytes, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetSlabStats(SlabStats_t *pxStats, UBaseType_t uxMaxClasses)
+{
+    UBaseType_t uxClass;
+
+    prvSlabInitialiseOnce();
+
+    for (uxClass = 0; uxClass <= uxSlabClassCount && uxClass < uxMaxClasses; uxClass++) {
+        SlabStats_t *pxClassStats = &pxStats[ uxClass ];
+
+        if (uxClass == uxSlabClassCount) {
+            /* The blocks malloc() served. */
+            pxClassStats->xBlockSize = 0;
+            pxClassStats->xBlocksCarved = 0;
+            pxClassStats->xBlocksInUse = __atomic_load_n(&xLargeInUse, __ATOMIC_RELAXED);
+            pxClassStats->ullAllocations = __atomic_load_n(&ullLargeAllocations, __ATOMIC_RELAXED);
+            pxClassStats->ullRequestedBytes = __atomic_load_n(&ullLargeRequestedBytes, __ATOMIC_RELAXED);
+            pxClassStats->ullOverflows = 0;
+        } else {
+            xSlabClass *pxClass = &xSlabClasses[ uxClass ];
+
+            pxClassStats->xBlockSize = pxClass->xBlockSize;
+            pxClassStats->xBlocksCarved = __atomic_load_n(&pxClass->xCarved, __ATOMIC_RELAXED);
+            pxClassStats->xBlocksInUse = __atomic_load_n(&pxClass->xInUse, __ATOMIC_RELAXED);
+            pxClassStats->ullAllocations = __atomic_load_n(&pxClass->ullAllocations, __ATOMIC_RELAXED);
+            pxClassStats->ullRequestedBytes = __atomic_load_n(&pxClass->ullRequestedBytes, __ATOMIC_RELAXED);
+            pxClassStats->ullOverflows = __atomic_load_n(&pxClass->ullOverflows, __ATOMIC_RELAXED);
+        }
+    }
+
+    return uxClass;
+}
+
+#endif /* configUSE_SLAB_HEAP */
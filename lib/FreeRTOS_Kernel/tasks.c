@@ -234,6 +234,24 @@ or suspended list then it won't be in a ready list. */
 
 /*-----------------------------------------------------------*/
 
+#if( ( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 ) && ( configDELAYED_LIST_ORDER == listORDER_TIMING_WHEEL ) )
+#error The timing wheel changes how the tick is processed, so it can only be selected at build time.  Set configUSE_DELAYED_LIST_ORDER_SELECTION to 0.
+#endif
+
+#if( configDELAYED_LIST_ORDER == listORDER_TIMING_WHEEL )
+
+/* The timing wheel works on the distance to the wake time, so a single list
+holds the delayed tasks across a tick count overflow and nothing needs to be
+switched.  The overflow only makes tasks that were beyond it reachable again,
+so the next unblock time has to be recalculated. */
+#define taskSWITCH_DELAYED_LISTS()                                                                  \
+    {                                                                                                   \
+        xNumOfOverflows++;                                                                              \
+        prvResetNextTaskUnblockTime();                                                                  \
+    }
+
+#else
+
 /* pxDelayedTaskList and pxOverflowDelayedTaskList are switched when the tick
 count overflows. */
 #define taskSWITCH_DELAYED_LISTS()                                                                  \
@@ -250,6 +268,8 @@ count overflows. */
         prvResetNextTaskUnblockTime();                                                                  \
     }
 
+#endif /* configDELAYED_LIST_ORDER */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -378,6 +398,23 @@ PRIVILEGED_DATA static List_t *volatile pxDelayedTaskList;              /*< Poin
 PRIVILEGED_DATA static List_t *volatile pxOverflowDelayedTaskList;      /*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
 PRIVILEGED_DATA static List_t xPendingReadyList;                        /*< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready list when the scheduler is resumed. */
 
+#if( configDELAYED_LIST_ORDER == listORDER_TIMING_WHEEL )
+
+PRIVILEGED_DATA static ListWheel_t xDelayedTaskWheel;                  /*< Slots of the timing wheel that xDelayedTaskList1 is kept in. */
+
+#elif( ( configDELAYED_LIST_ORDER == listORDER_PERIOD_BUCKETS ) || ( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 ) )
+
+PRIVILEGED_DATA static ListBuckets_t xDelayedTaskBuckets1;             /*< Buckets of xDelayedTaskList1 if it is kept in listORDER_PERIOD_BUCKETS order. */
+PRIVILEGED_DATA static ListBuckets_t xDelayedTaskBuckets2;             /*< Buckets of xDelayedTaskList2 if it is kept in listORDER_PERIOD_BUCKETS order. */
+
+#endif /* configDELAYED_LIST_ORDER */
+
+#if( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 )
+
+PRIVILEGED_DATA static UBaseType_t uxDelayedListOrder = configDELAYED_LIST_ORDER;    /*< Ordering of the delayed lists, see xTaskSetDelayedListOrder(). */
+
+#endif /* configUSE_DELAYED_LIST_ORDER_SELECTION */
+
 #if( INCLUDE_vTaskDelete == 1 )
 
 PRIVILEGED_DATA static List_t xTasksWaitingTermination;             /*< Tasks that have been deleted - but their memory not yet freed. */
@@ -454,6 +491,15 @@ static BaseType_t prvTaskIsTaskSuspended(const TaskHandle_t xTask) PRIVILEGED_FU
  */
 static void prvInitialiseTaskLists(void) PRIVILEGED_FUNCTION;
 
+#if( ( ( configDELAYED_LIST_ORDER != listORDER_SORTED_LIST ) && ( configDELAYED_LIST_ORDER != listORDER_TIMING_WHEEL ) ) || ( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 ) )
+
+/*
+ * Put the (empty) delayed lists into one of the listORDER_xxx orderings.
+ */
+static void prvSetDelayedListOrder(UBaseType_t uxOrder) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * The idle task, which as all tasks is implemented as a never ending loop.
  * The idle task is automatically created and added to the ready lists upon
@@ -480,6 +526,17 @@ static void prvDeleteTCB(TCB_t *pxTCB) PRIVILEGED_FUNCTION;
 
 #endif
 
+/*
+ * Used only by vTaskResetKernel().  Removes every task from pxList and frees
+ * its TCB.  The items of all list orderings stay linked into the list, so the
+ * head entry can be taken until the list is empty.
+ */
+#if ( INCLUDE_vTaskDelete == 1 )
+
+static void prvDeleteTasksWithinSingleList(List_t *pxList) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Used only by the idle task.  This checks to see if anything has been placed
  * in the list of tasks waiting to be deleted.  If so the task is cleaned up
@@ -677,6 +734,7 @@ BaseType_t xTaskCreate(TaskFunction_t pxTaskCode,
 {
     TCB_t *pxNewTCB;
     BaseType_t xReturn;
+    const uint32_t ulStackDepth = (uint32_t) portTASK_STACK_DEPTH(usStackDepth);
 
     /* If the stack grows down then allocate the stack then the TCB so the stack
     does not grow into the TCB.  Likewise if the stack grows up then allocate
@@ -692,7 +750,7 @@ BaseType_t xTaskCreate(TaskFunction_t pxTaskCode,
             /* Allocate space for the stack used by the task being created.
             The base of the stack memory stored in the TCB so the task can
             be deleted later if required. */
-            pxNewTCB->pxStack = (StackType_t *) pvPortMalloc((((size_t) usStackDepth) * sizeof(StackType_t)));             /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+            pxNewTCB->pxStack = (StackType_t *) pvPortMalloc((((size_t) ulStackDepth) * sizeof(StackType_t)));             /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
 
             if (pxNewTCB->pxStack == NULL) {
                 /* Could not allocate the stack.  Delete the allocated TCB. */
@@ -706,7 +764,7 @@ BaseType_t xTaskCreate(TaskFunction_t pxTaskCode,
         StackType_t *pxStack;
 
         /* Allocate space for the stack used by the task being created. */
-        pxStack = (StackType_t *) pvPortMalloc((((size_t) usStackDepth) * sizeof(StackType_t)));             /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+        pxStack = (StackType_t *) pvPortMalloc((((size_t) ulStackDepth) * sizeof(StackType_t)));             /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
 
         if (pxStack != NULL) {
             /* Allocate space for the TCB. */
@@ -737,7 +795,7 @@ BaseType_t xTaskCreate(TaskFunction_t pxTaskCode,
         }
 #endif /* configSUPPORT_STATIC_ALLOCATION */
 
-        prvInitialiseNewTask(pxTaskCode, pcName, (uint32_t) usStackDepth, pvParameters, uxPriority, pxCreatedTask, pxNewTCB, NULL);
+        prvInitialiseNewTask(pxTaskCode, pcName, ulStackDepth, pvParameters, uxPriority, pxCreatedTask, pxNewTCB, NULL);
         prvAddNewTaskToReadyList(pxNewTCB);
         xReturn = pdPASS;
     }
@@ -1817,6 +1875,80 @@ void vTaskEndScheduler(void)
 }
 /*----------------------------------------------------------*/
 
+#if ( INCLUDE_vTaskDelete == 1 )
+
+void vTaskResetKernel(void)
+{
+    UBaseType_t uxPriority;
+    BaseType_t xHeapDropped = pdFALSE;
+
+    /* Only called once vTaskStartScheduler() has returned, the port has ended
+    all the tasks so nothing else accesses the lists any more. */
+    configASSERT(xSchedulerRunning == pdFALSE);
+
+#if ( configUSE_TIMERS == 1 )
+    {
+        vTimerResetState();
+    }
+#endif /* configUSE_TIMERS */
+
+    /* With the slab heap every block of the run, the TCBs and stacks as well
+    as the queues, semaphores and timers of the application, is dropped at
+    once, unless the port still runs threads that may use it.  Otherwise the
+    tasks are freed one by one.  The lists are only initialised once the first
+    task is created.  The pending ready list holds the event list items of
+    tasks that are also referenced from one of the other lists, it is
+    initialised again with the other lists. */
+#if ( configUSE_SLAB_HEAP == 1 )
+    {
+        if (portHEAP_RESET_ALLOWED() != pdFALSE) {
+            xHeapDropped = xPortResetHeap();
+        }
+    }
+#endif /* configUSE_SLAB_HEAP */
+
+    if ((xHeapDropped == pdFALSE) && (uxCurrentNumberOfTasks > (UBaseType_t) 0U)) {
+        for (uxPriority = (UBaseType_t) 0U; uxPriority < (UBaseType_t) configMAX_PRIORITIES; uxPriority++) {
+            prvDeleteTasksWithinSingleList(&(pxReadyTasksLists[ uxPriority ]));
+        }
+
+        prvDeleteTasksWithinSingleList(&xDelayedTaskList1);
+        prvDeleteTasksWithinSingleList(&xDelayedTaskList2);
+        prvDeleteTasksWithinSingleList(&xTasksWaitingTermination);
+
+#if ( INCLUDE_vTaskSuspend == 1 )
+        {
+            prvDeleteTasksWithinSingleList(&xSuspendedTaskList);
+        }
+#endif /* INCLUDE_vTaskSuspend */
+    }
+
+    /* Start over as if no task had ever been created.  The first task created
+    next initialises the lists again. */
+    pxCurrentTCB = NULL;
+    uxDeletedTasksWaitingCleanUp = (UBaseType_t) 0U;
+    uxCurrentNumberOfTasks = (UBaseType_t) 0U;
+    xTickCount = (TickType_t) 0U;
+    uxTopReadyPriority = tskIDLE_PRIORITY;
+    uxPendedTicks = (UBaseType_t) 0U;
+    xYieldPending = pdFALSE;
+    xNumOfOverflows = (BaseType_t) 0;
+    uxTaskNumber = (UBaseType_t) 0U;
+    xNextTaskUnblockTime = (TickType_t) 0U;
+    xIdleTaskHandle = NULL;
+    uxSchedulerSuspended = (UBaseType_t) pdFALSE;
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+    {
+        ulTaskSwitchedInTime = 0UL;
+        ulTotalRunTime = 0UL;
+    }
+#endif /* configGENERATE_RUN_TIME_STATS */
+}
+
+#endif /* INCLUDE_vTaskDelete */
+/*----------------------------------------------------------*/
+
 void vTaskSuspendAll(void)
 {
     /* A critical section is not required as the variable is of type
@@ -2183,7 +2315,9 @@ UBaseType_t uxTaskGetSystemState(TaskStatus_t *const pxTaskStatusArray, const UB
             /* Fill in an TaskStatus_t structure with information on each
             task in the Blocked state. */
             uxTask += prvListTasksWithinSingleList(&(pxTaskStatusArray[ uxTask ]), (List_t *) pxDelayedTaskList, eBlocked);
-            uxTask += prvListTasksWithinSingleList(&(pxTaskStatusArray[ uxTask ]), (List_t *) pxOverflowDelayedTaskList, eBlocked);
+            if (pxOverflowDelayedTaskList != pxDelayedTaskList) {
+                uxTask += prvListTasksWithinSingleList(&(pxTaskStatusArray[ uxTask ]), (List_t *) pxOverflowDelayedTaskList, eBlocked);
+            }
 
 #if( INCLUDE_vTaskDelete == 1 )
             {
@@ -2263,6 +2397,28 @@ void vTaskStepTick(const TickType_t xTicksToJump)
 #endif /* configUSE_TICKLESS_IDLE */
 /*----------------------------------------------------------*/
 
+BaseType_t xTaskCatchUpTicks(TickType_t xTicksToCatchUp)
+{
+    BaseType_t xYieldOccurred;
+
+    /* Must not be called with the scheduler suspended, the ticks would only
+    be processed when the caller resumes it. */
+    configASSERT(uxSchedulerSuspended == 0);
+
+    /* The tick interrupt also increments uxPendedTicks while the scheduler is
+    suspended, so the addition must not be interrupted by it. */
+    vTaskSuspendAll();
+    taskENTER_CRITICAL();
+    {
+        uxPendedTicks += xTicksToCatchUp;
+    }
+    taskEXIT_CRITICAL();
+    xYieldOccurred = xTaskResumeAll();
+
+    return xYieldOccurred;
+}
+/*----------------------------------------------------------*/
+
 #if ( INCLUDE_xTaskAbortDelay == 1 )
 
 BaseType_t xTaskAbortDelay(TaskHandle_t xTask)
@@ -2357,6 +2513,45 @@ BaseType_t xTaskIncrementTick(void)
             mtCOVERAGE_TEST_MARKER();
         }
 
+#if( configDELAYED_LIST_ORDER == listORDER_TIMING_WHEEL )
+        /* See if this tick has made a timeout expire.  The wheel hands out
+        exactly the tasks that are due, so there is nothing to compare. */
+        if (xConstTickCount >= xNextTaskUnblockTime) {
+            while ((pxTCB = (TCB_t *) pvListWheelGetDueOwner(pxDelayedTaskList, xConstTickCount)) != NULL) {
+                /* It is time to remove the item from the Blocked state. */
+                (void) uxListRemove(&(pxTCB->xStateListItem));
+
+                /* Is the task waiting on an event also?  If so remove it from
+                the event list. */
+                if (listLIST_ITEM_CONTAINER(&(pxTCB->xEventListItem)) != NULL) {
+                    (void) uxListRemove(&(pxTCB->xEventListItem));
+                }
+                else {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                /* Place the unblocked task into the appropriate ready list. */
+                prvAddTaskToReadyList(pxTCB);
+
+                /* A task being unblocked cannot cause an immediate context
+                switch if preemption is turned off. */
+#if (  configUSE_PREEMPTION == 1 )
+                {
+                    if (pxTCB->uxPriority >= pxCurrentTCB->uxPriority) {
+                        xSwitchRequired = pdTRUE;
+                    }
+                    else {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+#endif /* configUSE_PREEMPTION */
+            }
+
+            prvResetNextTaskUnblockTime();
+        }
+
+        (void) xItemValue;
+#else
         /* See if this tick has made a timeout expire.  Tasks are stored in
         the queue in the order of their wake time - meaning once one task
         has been found whose block time has not expired there is no need to
@@ -2428,6 +2623,7 @@ BaseType_t xTaskIncrementTick(void)
                 }
             }
         }
+#endif /* configDELAYED_LIST_ORDER */
 
         /* Tasks of equal priority to the currently running task will share
         processing time (time slice) if preemption is on, and the application
@@ -3115,6 +3311,20 @@ static void prvInitialiseTaskLists(void)
     vListInitialise(&xDelayedTaskList2);
     vListInitialise(&xPendingReadyList);
 
+#if( configDELAYED_LIST_ORDER == listORDER_TIMING_WHEEL )
+    {
+        vListInitialiseWheel(&xDelayedTaskList1, &xDelayedTaskWheel, xTickCount);
+    }
+#elif( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 )
+    {
+        prvSetDelayedListOrder(uxDelayedListOrder);
+    }
+#elif( configDELAYED_LIST_ORDER != listORDER_SORTED_LIST )
+    {
+        prvSetDelayedListOrder(configDELAYED_LIST_ORDER);
+    }
+#endif /* configDELAYED_LIST_ORDER */
+
 #if ( INCLUDE_vTaskDelete == 1 )
     {
         vListInitialise(&xTasksWaitingTermination);
@@ -3131,6 +3341,85 @@ static void prvInitialiseTaskLists(void)
     using list2. */
     pxDelayedTaskList = &xDelayedTaskList1;
     pxOverflowDelayedTaskList = &xDelayedTaskList2;
+
+#if( configDELAYED_LIST_ORDER == listORDER_TIMING_WHEEL )
+    {
+        /* The wheel takes wake times beyond the tick count overflow as well,
+        so tasks that would go to the overflow list share the wheel. */
+        pxOverflowDelayedTaskList = &xDelayedTaskList1;
+    }
+#endif /* configDELAYED_LIST_ORDER */
+}
+/*-----------------------------------------------------------*/
+
+#if( ( ( configDELAYED_LIST_ORDER != listORDER_SORTED_LIST ) && ( configDELAYED_LIST_ORDER != listORDER_TIMING_WHEEL ) ) || ( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 ) )
+
+static void prvSetDelayedListOrder(UBaseType_t uxOrder)
+{
+    /* Only the delayed lists use the alternative ordering, everything else
+    relies on the lists being fully sorted. */
+#if( configUSE_SKIP_LISTS == 1 )
+    if (uxOrder == listORDER_SORTED_LIST) {
+        /* Every sorted list is kept as a skip list. */
+        uxOrder = listORDER_SKIP_LIST;
+    }
+#endif
+
+#if( ( configDELAYED_LIST_ORDER == listORDER_PERIOD_BUCKETS ) || ( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 ) )
+    if (uxOrder == listORDER_PERIOD_BUCKETS) {
+        vListInitialiseBuckets(&xDelayedTaskList1, &xDelayedTaskBuckets1);
+        vListInitialiseBuckets(&xDelayedTaskList2, &xDelayedTaskBuckets2);
+    }
+    else
+#endif
+    {
+        vListSetOrder(&xDelayedTaskList1, uxOrder);
+        vListSetOrder(&xDelayedTaskList2, uxOrder);
+    }
+}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if( configUSE_DELAYED_LIST_ORDER_SELECTION == 1 )
+
+BaseType_t xTaskSetDelayedListOrder(UBaseType_t uxOrder)
+{
+    BaseType_t xReturn;
+
+    if ((xSchedulerRunning == pdFALSE) && (uxOrder != listORDER_TIMING_WHEEL) && (uxOrder <= listORDER_SKIP_LIST)) {
+        uxDelayedListOrder = uxOrder;
+
+        /* The lists are initialised when the first task is created.  No task
+        can have been delayed before the scheduler is started, so if they
+        already are they are still empty and can be switched over. */
+        if (listLIST_IS_INITIALISED(&xDelayedTaskList1)) {
+            prvSetDelayedListOrder(uxOrder);
+        }
+        else {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        xReturn = pdPASS;
+    }
+    else {
+        xReturn = pdFAIL;
+    }
+
+    return xReturn;
+}
+
+#endif /* configUSE_DELAYED_LIST_ORDER_SELECTION */
+/*-----------------------------------------------------------*/
+
+void vTaskGetDelayedListStats(ListStats_t *const pxStats)
+{
+    /* The items are walked, so keep the list from changing meanwhile. */
+    vTaskSuspendAll();
+    {
+        vListGetStats(pxDelayedTaskList, pxStats);
+    }
+    (void) xTaskResumeAll();
 }
 /*-----------------------------------------------------------*/
 
@@ -3389,6 +3678,41 @@ static void prvDeleteTCB(TCB_t *pxTCB)
 #endif /* INCLUDE_vTaskDelete */
 /*-----------------------------------------------------------*/
 
+#if ( INCLUDE_vTaskDelete == 1 )
+
+static void prvDeleteTasksWithinSingleList(List_t *pxList)
+{
+    TCB_t *pxTCB;
+
+    while (listLIST_IS_EMPTY(pxList) == pdFALSE) {
+        pxTCB = (TCB_t *) listGET_OWNER_OF_HEAD_ENTRY(pxList);
+        (void) uxListRemove(&(pxTCB->xStateListItem));
+        prvDeleteTCB(pxTCB);
+    }
+}
+
+#endif /* INCLUDE_vTaskDelete */
+/*-----------------------------------------------------------*/
+
+#if( configDELAYED_LIST_ORDER == listORDER_TIMING_WHEEL )
+
+static void prvResetNextTaskUnblockTime(void)
+{
+    const TickType_t xTicks = xListWheelTicksUntilDue(pxDelayedTaskList, xTickCount);
+
+    /* The wheel only gives a lower bound, waking early just finds nothing
+    due.  Tasks due after the tick count overflows are picked up again when
+    the overflow recalculates the unblock time, as with the overflow list. */
+    if ((xTicks == portMAX_DELAY) || ((TickType_t)(xTickCount + xTicks) < xTickCount)) {
+        xNextTaskUnblockTime = portMAX_DELAY;
+    }
+    else {
+        xNextTaskUnblockTime = xTickCount + xTicks;
+    }
+}
+
+#else
+
 static void prvResetNextTaskUnblockTime(void)
 {
     TCB_t *pxTCB;
@@ -3409,6 +3733,8 @@ static void prvResetNextTaskUnblockTime(void)
         xNextTaskUnblockTime = listGET_LIST_ITEM_VALUE(&((pxTCB)->xStateListItem));
     }
 }
+
+#endif /* configDELAYED_LIST_ORDER */
 /*-----------------------------------------------------------*/
 
 #if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
@@ -4399,6 +4725,11 @@ static void prvAddCurrentTaskToDelayedList(TickType_t xTicksToWait, const BaseTy
             /* The list item will be inserted in wake time order. */
             listSET_LIST_ITEM_VALUE(&(pxCurrentTCB->xStateListItem), xTimeToWake);
 
+            /* Tasks that block for the same number of ticks are inserted in
+            wake time order, so they can share a bucket - for a periodic task
+            that runs in the tick it is released this is its period. */
+            listSET_LIST_ITEM_BUCKET_KEY(&(pxCurrentTCB->xStateListItem), xTicksToWait);
+
             if (xTimeToWake < xConstTickCount) {
                 /* Wake time has overflowed.  Place this item in the overflow
                 list. */
@@ -4431,6 +4762,10 @@ static void prvAddCurrentTaskToDelayedList(TickType_t xTicksToWait, const BaseTy
         /* The list item will be inserted in wake time order. */
         listSET_LIST_ITEM_VALUE(&(pxCurrentTCB->xStateListItem), xTimeToWake);
 
+        /* Tasks that block for the same number of ticks are inserted in wake
+        time order, so they can share a bucket. */
+        listSET_LIST_ITEM_BUCKET_KEY(&(pxCurrentTCB->xStateListItem), xTicksToWait);
+
         if (xTimeToWake < xConstTickCount) {
             /* Wake time has overflowed.  Place this item in the overflow list. */
             vListInsert(pxOverflowDelayedTaskList, &(pxCurrentTCB->xStateListItem));
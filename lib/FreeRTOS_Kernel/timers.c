@@ -168,6 +168,9 @@ PRIVILEGED_DATA static List_t *pxOverflowTimerList;
 PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
 PRIVILEGED_DATA static TaskHandle_t xTimerTaskHandle = NULL;
 
+/* The tick count the timer lists were last checked at, to detect an overflow. */
+PRIVILEGED_DATA static TickType_t xLastTime = (TickType_t) 0U;   /*lint !e956 Variable is only accessible to one task. */
+
 /*lint +e956 */
 
 /*-----------------------------------------------------------*/
@@ -630,7 +633,6 @@ static TickType_t prvGetNextExpireTime(BaseType_t *const pxListWasEmpty)
 static TickType_t prvSampleTimeNow(BaseType_t *const pxTimerListsWereSwitched)
 {
     TickType_t xTimeNow;
-    PRIVILEGED_DATA static TickType_t xLastTime = (TickType_t) 0U;   /*lint !e956 Variable is only accessible to one task. */
 
     xTimeNow = xTaskGetTickCount();
 
@@ -1023,6 +1025,21 @@ BaseType_t xTimerPendFunctionCall(PendedFunction_t xFunctionToPend, void *pvPara
 #endif /* INCLUDE_xTimerPendFunctionCall */
 /*-----------------------------------------------------------*/
 
+void vTimerResetState(void)
+{
+    /* Called by vTaskResetKernel() once the scheduler has ended, which frees
+    the timer service task.  The queue and the lists are created again when
+    the next timer or timer task is. */
+    if (xTimerQueue != NULL) {
+        vQueueDelete(xTimerQueue);
+        xTimerQueue = NULL;
+    }
+
+    xTimerTaskHandle = NULL;
+    xLastTime = (TickType_t) 0U;
+}
+/*-----------------------------------------------------------*/
+
 /* This entire source file will be skipped if the application is not configured
 to include software timer functionality.  If you want to include software timer
 functionality then ensure configUSE_TIMERS is set to 1 in FreeRTOSConfig.h. */
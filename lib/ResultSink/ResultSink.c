@@ -0,0 +1,414 @@
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ResultSink.h"
+
+#define PRINT_CHECK                                                            \
+    fprintf(stderr, "[ERRNO: %s] %s:%d -> %s\n", strerror(errno),          \
+            __FILE__, __LINE__, __func__);
+
+#define RS_INITIAL_CAPACITY (1 << 20)
+#define RS_TYPES 16
+#define RS_PATH_SIZE 4096
+
+typedef struct rs_text {
+    char *data;
+    size_t length;
+    size_t capacity;
+} rs_text_t;
+
+/* Last header written for a type, CSV only */
+typedef struct rs_type {
+    char *type;
+    char *header;
+} rs_type_t;
+
+static char *rs_path = NULL;
+static int rs_csv = 0;
+static long rs_records = 0;
+static rs_text_t rs_output;
+static rs_text_t rs_names;
+static rs_text_t rs_values;
+static const char *rs_type_of_record;
+static rs_type_t rs_types[RS_TYPES];
+
+/* A failed allocation truncates the text, rsClose() reports it */
+static int rs_failed = 0;
+
+static void rsAppend(rs_text_t *text, const char *data, size_t length)
+{
+    if (text->length + length + 1 > text->capacity) {
+        size_t capacity = text->capacity ? text->capacity : 256;
+        char *grown;
+
+        while (text->length + length + 1 > capacity) {
+            capacity *= 2;
+        }
+        grown = realloc(text->data, capacity);
+        if (!grown) {
+            rs_failed = 1;
+            return;
+        }
+        text->data = grown;
+        text->capacity = capacity;
+    }
+
+    memcpy(text->data + text->length, data, length);
+    text->length += length;
+    text->data[text->length] = '\0';
+}
+
+static void rsAppendString(rs_text_t *text, const char *string)
+{
+    rsAppend(text, string, strlen(string));
+}
+
+static void rsAppendFormat(rs_text_t *text, const char *format, ...)
+{
+    char buffer[64];
+    va_list args;
+    int length;
+
+    va_start(args, format);
+    length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (length > 0) {
+        rsAppend(text, buffer,
+                 (size_t)length < sizeof(buffer) ? (size_t)length :
+                 sizeof(buffer) - 1);
+    }
+}
+
+/* Text as JSON string or CSV field, quoted where needed */
+static void rsAppendQuoted(rs_text_t *text, const char *string)
+{
+    const char *c;
+
+    if (!rs_csv) {
+        rsAppend(text, "\"", 1);
+        for (c = string; *c; c++) {
+            if (*c == '"' || *c == '\\') {
+                rsAppend(text, "\\", 1);
+                rsAppend(text, c, 1);
+            }
+            else if ((unsigned char)*c < 0x20) {
+                rsAppendFormat(text, "\\u%04x", (unsigned char)*c);
+            }
+            else {
+                rsAppend(text, c, 1);
+            }
+        }
+        rsAppend(text, "\"", 1);
+        return;
+    }
+
+    if (!strpbrk(string, ",\"\r\n")) {
+        rsAppendString(text, string);
+        return;
+    }
+
+    rsAppend(text, "\"", 1);
+    for (c = string; *c; c++) {
+        if (*c == '"') {
+            rsAppend(text, "\"", 1);
+        }
+        rsAppend(text, c, 1);
+    }
+    rsAppend(text, "\"", 1);
+}
+
+static void rsAppendName(const char *name)
+{
+    if (rs_csv) {
+        rsAppend(&rs_names, ",", 1);
+        rsAppendString(&rs_names, name);
+    }
+    else {
+        rsAppend(&rs_values, ",", 1);
+        rsAppendQuoted(&rs_values, name);
+        rsAppend(&rs_values, ":", 1);
+    }
+}
+
+static void rsAppendSeparator(void)
+{
+    if (rs_csv) {
+        rsAppend(&rs_values, ",", 1);
+    }
+}
+
+int rsOpen(const char *path, int part)
+{
+    char name[RS_PATH_SIZE];
+    size_t length = strlen(path);
+
+    if (rs_path) {
+        return -1;
+    }
+
+    if (part >= 0) {
+        snprintf(name, sizeof(name), "%s.%d", path, part);
+        rs_path = strdup(name);
+    }
+    else {
+        rs_path = strdup(path);
+    }
+    rs_output.data = malloc(RS_INITIAL_CAPACITY);
+    if (!rs_path || !rs_output.data) {
+        free(rs_path);
+        free(rs_output.data);
+        rs_path = NULL;
+        rs_output.data = NULL;
+        return -1;
+    }
+    rs_output.length = 0;
+    rs_output.capacity = RS_INITIAL_CAPACITY;
+    rs_csv = length >= 4 && !strcmp(path + length - 4, ".csv");
+    rs_records = 0;
+    rs_failed = 0;
+
+    return 0;
+}
+
+int rsIsOpen(void)
+{
+    return rs_path != NULL;
+}
+
+void rsBegin(const char *type)
+{
+    rs_names.length = 0;
+    rs_values.length = 0;
+    rs_type_of_record = type;
+
+    if (!rs_csv) {
+        rsAppendString(&rs_values, "{\"type\":");
+        rsAppendQuoted(&rs_values, type);
+    }
+}
+
+void rsString(const char *name, const char *value)
+{
+    rsAppendName(name);
+    rsAppendSeparator();
+    rsAppendQuoted(&rs_values, value);
+}
+
+void rsUnsigned(const char *name, uint64_t value)
+{
+    rsAppendName(name);
+    rsAppendSeparator();
+    rsAppendFormat(&rs_values, "%llu", (unsigned long long)value);
+}
+
+void rsDouble(const char *name, double value)
+{
+    rsAppendName(name);
+    rsAppendSeparator();
+    if (isfinite(value)) {
+        rsAppendFormat(&rs_values, "%.9g", value);
+    }
+    else if (!rs_csv) {
+        rsAppendString(&rs_values, "null");
+    }
+}
+
+void rsEnd(void)
+{
+    rs_type_t *type = NULL;
+    unsigned i;
+
+    if (!rs_path) {
+        return;
+    }
+
+    if (!rs_csv) {
+        rsAppend(&rs_values, "}\n", 2);
+        rsAppend(&rs_output, rs_values.data, rs_values.length);
+        rs_records++;
+        return;
+    }
+
+    /* A header line whenever the fields of the type change */
+    for (i = 0; i < RS_TYPES && rs_types[i].type; i++) {
+        if (!strcmp(rs_types[i].type, rs_type_of_record)) {
+            type = &rs_types[i];
+            break;
+        }
+    }
+    if (!type && i < RS_TYPES) {
+        type = &rs_types[i];
+        type->type = strdup(rs_type_of_record);
+    }
+    if (!type || !type->header || !rs_names.data ||
+        strcmp(type->header, rs_names.data)) {
+        rsAppendString(&rs_output, "type");
+        rsAppend(&rs_output, rs_names.data, rs_names.length);
+        rsAppend(&rs_output, "\n", 1);
+        if (type) {
+            free(type->header);
+            type->header = rs_names.data ? strdup(rs_names.data) : NULL;
+        }
+    }
+
+    rsAppendQuoted(&rs_output, rs_type_of_record);
+    rsAppend(&rs_output, rs_values.data, rs_values.length);
+    rsAppend(&rs_output, "\n", 1);
+    rs_records++;
+}
+
+long rsClose(void)
+{
+    long records = rs_records;
+    FILE *file;
+    unsigned i;
+
+    if (!rs_path) {
+        return -1;
+    }
+
+    file = fopen(rs_path, "w");
+    if (!file) {
+        PRINT_CHECK
+        records = -1;
+    }
+    else {
+        if (fwrite(rs_output.data, 1, rs_output.length, file) !=
+            rs_output.length) {
+            PRINT_CHECK
+            records = -1;
+        }
+        if (fclose(file)) {
+            records = -1;
+        }
+    }
+    if (rs_failed) {
+        fprintf(stderr, "Out of memory, results in '%s' are incomplete\n",
+                rs_path);
+        records = -1;
+    }
+
+    for (i = 0; i < RS_TYPES; i++) {
+        free(rs_types[i].type);
+        free(rs_types[i].header);
+        rs_types[i].type = NULL;
+        rs_types[i].header = NULL;
+    }
+    free(rs_output.data);
+    free(rs_names.data);
+    free(rs_values.data);
+    memset(&rs_output, 0, sizeof(rs_output));
+    memset(&rs_names, 0, sizeof(rs_names));
+    memset(&rs_values, 0, sizeof(rs_values));
+    free(rs_path);
+    rs_path = NULL;
+
+    return records;
+}
+
+/* Length of the type field at the start of a CSV record line */
+static size_t rsTypeLength(const char *line)
+{
+    const char *c = line;
+
+    if (*c == '"') {
+        for (c++; *c && (*c != '"' || c[1] == '"'); c++) {
+            if (*c == '"') {
+                c++;
+            }
+        }
+        if (*c) {
+            c++;
+        }
+        return c - line;
+    }
+    return strcspn(line, ",\n");
+}
+
+int rsMerge(const char *path, int parts)
+{
+    char part[RS_PATH_SIZE];
+    rs_type_t types[RS_TYPES] = { { NULL, NULL } };
+    size_t length = strlen(path);
+    int csv = length >= 4 && !strcmp(path + length - 4, ".csv");
+    char *pending = NULL;
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t read;
+    int merged = 0;
+    FILE *out, *in;
+    int i, j;
+
+    out = fopen(path, "w");
+    if (!out) {
+        PRINT_CHECK
+        return -1;
+    }
+
+    for (i = 0; i < parts; i++) {
+        snprintf(part, sizeof(part), "%s.%d", path, i);
+        in = fopen(part, "r");
+        if (!in) {
+            continue;
+        }
+
+        while ((read = getline(&line, &size, in)) > 0) {
+            /* A header belongs to the record after it, like in rsEnd() it is
+            only written if it differs from the last one of that type */
+            if (csv && !strncmp(line, "type,", 5)) {
+                free(pending);
+                pending = strdup(line);
+                continue;
+            }
+            if (csv && pending) {
+                length = rsTypeLength(line);
+                for (j = 0; j < RS_TYPES && types[j].type; j++) {
+                    if (strlen(types[j].type) == length &&
+                        !strncmp(types[j].type, line, length)) {
+                        break;
+                    }
+                }
+                if (j < RS_TYPES && !types[j].type) {
+                    types[j].type = strndup(line, length);
+                }
+                if (j == RS_TYPES || !types[j].header ||
+                    strcmp(types[j].header, pending)) {
+                    fputs(pending, out);
+                }
+                if (j < RS_TYPES) {
+                    free(types[j].header);
+                    types[j].header = pending;
+                }
+                else {
+                    free(pending);
+                }
+                pending = NULL;
+            }
+            fwrite(line, 1, read, out);
+        }
+
+        fclose(in);
+        remove(part);
+        merged++;
+    }
+
+    free(line);
+    free(pending);
+    for (j = 0; j < RS_TYPES; j++) {
+        free(types[j].type);
+        free(types[j].header);
+    }
+
+    if (fclose(out)) {
+        PRINT_CHECK
+        return -1;
+    }
+
+    return merged;
+}
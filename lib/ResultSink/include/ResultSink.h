@@ -0,0 +1,121 @@
+/**
+ * @file ResultSink.h
+ * @date 17 October 2026
+ * @brief Machine readable results, written as CSV or JSON Lines into a file
+ * in one go when the program ends.
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#ifndef __RESULTSINK_H__
+#define __RESULTSINK_H__
+
+#include <stdint.h>
+
+/**
+ * @defgroup rs_sink Result Sink API
+ *
+ * @brief Collects records of named fields and writes them to a file
+ *
+ * A record has a type, eg. "run" or "task", and fields that are added between
+ * rsBegin() and rsEnd(). With JSON Lines every record is an object on a line
+ * of its own, with the type as field "type". With CSV every line starts with
+ * the type, and a header line "type,<field names>" comes before the first
+ * record of a type and whenever its fields change. The records are kept in
+ * memory and written by rsClose(), so nothing is written while a simulation
+ * runs. Not thread safe, records are meant to be written after the scheduler
+ * has ended.
+ *
+ * @{
+ */
+
+/**
+ * @brief Starts collecting records for a file
+ *
+ * @param path Path of the file, CSV if it ends in ".csv", JSON Lines
+ * otherwise. It is only created by rsClose().
+ * @param part If not negative the records go to path.<part> instead, in the
+ * format of path, to be joined with the other parts by rsMerge()
+ * @return returns 0 on success; -1 if the sink is already open or out of
+ * memory.
+ */
+int rsOpen(const char *path, int part);
+
+/**
+ * @brief Whether rsOpen() was called and rsClose() not yet
+ *
+ * @return 1 if records are collected, 0 otherwise
+ */
+int rsIsOpen(void);
+
+/**
+ * @brief Starts a record
+ *
+ * @param type Type of the record
+ */
+void rsBegin(const char *type);
+
+/**
+ * @brief Adds a text field to the record
+ *
+ * @param name Name of the field
+ * @param value Text, quoted and escaped as the format needs
+ */
+void rsString(const char *name, const char *value);
+
+/**
+ * @brief Adds an unsigned number to the record
+ *
+ * @param name Name of the field
+ * @param value The number
+ */
+void rsUnsigned(const char *name, uint64_t value);
+
+/**
+ * @brief Adds a floating point number to the record
+ *
+ * @param name Name of the field
+ * @param value The number
+ */
+void rsDouble(const char *name, double value);
+
+/**
+ * @brief Ends the record started by rsBegin()
+ */
+void rsEnd(void);
+
+/**
+ * @brief Writes all records to the file and stops collecting
+ *
+ * @return Number of records written, or -1 if the file could not be written
+ */
+long rsClose(void);
+
+/**
+ * @brief Appends the parts path.0 to path.<parts - 1> to path and removes
+ * them, eg. the results of several processes
+ *
+ * A CSV header line is left out if it matches the last header written for
+ * the type of the record after it.
+ *
+ * @param path Path of the file the parts are appended to, it is truncated
+ * @param parts Number of parts, missing parts are skipped
+ * @return Number of parts appended, or -1 if path could not be written
+ */
+int rsMerge(const char *path, int parts);
+
+/** @} */
+#endif
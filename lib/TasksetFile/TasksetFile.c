@@ -0,0 +1,256 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "TasksetFile.h"
+
+#define PRINT_CHECK                                                            \
+    fprintf(stderr, "[ERRNO: %s] %s:%d -> %s\n", strerror(errno),          \
+            __FILE__, __LINE__, __func__);
+
+#define TS_MAGIC "TASKSETS"
+#define TS_ALIGNMENT 8
+#define TS_INDEX_CAPACITY 1024
+
+typedef struct ts_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t count;
+    uint64_t index; /* position of the index, it follows the tasksets */
+} ts_header_t;
+
+/* Bytes a taskset takes in the file, including its padding */
+static uint64_t tsEntrySize(uint32_t flags, uint32_t tasks)
+{
+    uint64_t arrays = 1;
+
+    arrays += (flags & TS_HAS_OFFSETS) ? 1 : 0;
+    arrays += (flags & TS_HAS_WCETS) ? 1 : 0;
+    arrays += (flags & TS_HAS_JITTERS) ? 1 : 0;
+
+    return (sizeof(ts_entry_t) + arrays * tasks * sizeof(uint32_t) +
+            TS_ALIGNMENT - 1) & ~(uint64_t)(TS_ALIGNMENT - 1);
+}
+
+int tsOpen(ts_file_t *file, const char *path)
+{
+    const ts_header_t *header;
+    struct stat info;
+    void *data;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &info) || !S_ISREG(info.st_mode) ||
+        (uint64_t)info.st_size < sizeof(ts_header_t)) {
+        close(fd);
+        return -1;
+    }
+
+    data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        PRINT_CHECK
+        return -1;
+    }
+
+    /* Text tasksets are told apart by the header, so that is no error */
+    header = data;
+    if (memcmp(header->magic, TS_MAGIC, sizeof(header->magic)) ||
+        header->version != TS_VERSION || header->index % TS_ALIGNMENT ||
+        header->index > (uint64_t)info.st_size ||
+        header->count > ((uint64_t)info.st_size - header->index) /
+        sizeof(uint64_t)) {
+        munmap(data, info.st_size);
+        return -1;
+    }
+
+    file->data = data;
+    file->size = info.st_size;
+    file->count = header->count;
+    file->flags = header->flags;
+    file->index = (const uint64_t *)(file->data + header->index);
+
+    return 0;
+}
+
+void tsClose(ts_file_t *file)
+{
+    if (file->data) {
+        munmap((void *)file->data, file->size);
+        file->data = NULL;
+    }
+}
+
+const ts_entry_t *tsGet(const ts_file_t *file, uint64_t index)
+{
+    const ts_entry_t *entry;
+    uint64_t position;
+
+    if (index >= file->count) {
+        return NULL;
+    }
+
+    position = file->index[index];
+    if (position % TS_ALIGNMENT || position < sizeof(ts_header_t) ||
+        position > file->size - sizeof(ts_entry_t)) {
+        return NULL;
+    }
+
+    entry = (const ts_entry_t *)(file->data + position);
+    if (tsEntrySize(file->flags, entry->tasks) > file->size - position) {
+        return NULL;
+    }
+
+    return entry;
+}
+
+const uint32_t *tsOffsets(const ts_file_t *file, const ts_entry_t *entry)
+{
+    if (!(file->flags & TS_HAS_OFFSETS)) {
+        return NULL;
+    }
+
+    return tsPeriods(entry) + entry->tasks;
+}
+
+const uint32_t *tsWcets(const ts_file_t *file, const ts_entry_t *entry)
+{
+    if (!(file->flags & TS_HAS_WCETS)) {
+        return NULL;
+    }
+
+    return tsPeriods(entry) +
+           ((file->flags & TS_HAS_OFFSETS) ? 2 : 1) * entry->tasks;
+}
+
+const uint32_t *tsJitters(const ts_file_t *file, const ts_entry_t *entry)
+{
+    uint32_t arrays = 1;
+
+    if (!(file->flags & TS_HAS_JITTERS)) {
+        return NULL;
+    }
+
+    arrays += (file->flags & TS_HAS_OFFSETS) ? 1 : 0;
+    arrays += (file->flags & TS_HAS_WCETS) ? 1 : 0;
+
+    return tsPeriods(entry) + arrays * entry->tasks;
+}
+
+int tsWriterOpen(ts_writer_t *writer, const char *path, uint32_t flags)
+{
+    ts_header_t header = { 0 };
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        PRINT_CHECK
+        return -1;
+    }
+
+    writer->flags = flags & (TS_HAS_OFFSETS | TS_HAS_WCETS | TS_HAS_JITTERS);
+    writer->count = 0;
+    writer->capacity = 0;
+    writer->index = NULL;
+    writer->position = sizeof(header);
+
+    /* Written again with the count and the index by tsWriterClose() */
+    if (fwrite(&header, sizeof(header), 1, writer->file) != 1) {
+        PRINT_CHECK
+        fclose(writer->file);
+        return -1;
+    }
+
+    return 0;
+}
+
+int tsWriterAdd(ts_writer_t *writer, uint64_t id, uint32_t duration,
+                uint32_t tasks, const uint32_t *periods,
+                const uint32_t *offsets, const uint32_t *wcets,
+                const uint32_t *jitters)
+{
+    static const uint8_t padding[TS_ALIGNMENT] = { 0 };
+    ts_entry_t entry = { id, duration, tasks };
+    const uint32_t *arrays[3] = { offsets, wcets, jitters };
+    const uint32_t flags[3] = { TS_HAS_OFFSETS, TS_HAS_WCETS, TS_HAS_JITTERS };
+    uint64_t size = tsEntrySize(writer->flags, tasks);
+    uint64_t unpadded;
+    int i;
+
+    if (writer->count == writer->capacity) {
+        uint64_t capacity = writer->capacity ? 2 * writer->capacity :
+                            TS_INDEX_CAPACITY;
+        uint64_t *index = realloc(writer->index, capacity * sizeof(uint64_t));
+
+        if (!index) {
+            return -1;
+        }
+        writer->index = index;
+        writer->capacity = capacity;
+    }
+
+    /* The padding follows from the size the entry must have, so a short
+     * write of the arrays can't make it longer than the padding array */
+    unpadded = sizeof(entry) + sizeof(uint32_t) * (uint64_t)tasks;
+    if (fwrite(&entry, sizeof(entry), 1, writer->file) != 1 ||
+        fwrite(periods, sizeof(uint32_t), tasks, writer->file) != tasks) {
+        PRINT_CHECK
+        return -1;
+    }
+    for (i = 0; i < 3; i++) {
+        if (!(writer->flags & flags[i])) {
+            continue;
+        }
+        unpadded += sizeof(uint32_t) * (uint64_t)tasks;
+        if (fwrite(arrays[i], sizeof(uint32_t), tasks, writer->file) != tasks) {
+            PRINT_CHECK
+            return -1;
+        }
+    }
+    if (fwrite(padding, 1, size - unpadded, writer->file) != size - unpadded) {
+        PRINT_CHECK
+        return -1;
+    }
+
+    writer->index[writer->count++] = writer->position;
+    writer->position += size;
+
+    return 0;
+}
+
+long tsWriterClose(ts_writer_t *writer)
+{
+    ts_header_t header = { 0 };
+    int failed;
+
+    memcpy(header.magic, TS_MAGIC, sizeof(header.magic));
+    header.version = TS_VERSION;
+    header.flags = writer->flags;
+    header.count = writer->count;
+    header.index = writer->position;
+
+    failed = fwrite(writer->index, sizeof(uint64_t), writer->count,
+                    writer->file) != writer->count;
+    failed |= fseek(writer->file, 0, SEEK_SET) ||
+              fwrite(&header, sizeof(header), 1, writer->file) != 1;
+    failed |= fclose(writer->file) != 0;
+
+    free(writer->index);
+    writer->index = NULL;
+
+    if (failed) {
+        PRINT_CHECK
+        return -1;
+    }
+
+    return writer->count;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file TasksetFile.h
+ * @date 17 October 2026
+ * @brief A versioned binary container holding many tasksets that is mapped
+ * into memory and read in place.
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#ifndef __TASKSETFILE_H__
+#define __TASKSETFILE_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @defgroup ts_file Taskset File API
+ *
+ * @brief Stores many tasksets in one file that needs no parsing
+ *
+ * The file starts with a header, followed by the tasksets and an index with
+ * the position of every taskset. A taskset is a ts_entry_t followed by one
+ * period per task and, if the file has them, one offset, one worst case
+ * execution time and one release jitter per task, padded to 8 bytes. Periods,
+ * offsets and jitters are in ticks, execution times in microseconds. tsOpen()
+ * maps the file, the tasksets are then read straight from the mapping.
+ *
+ * @{
+ */
+
+/**
+ * @brief Version of the format written by tsWriterOpen()
+ */
+#define TS_VERSION 1
+
+/**
+ * @brief The tasksets of the file have an offset per task
+ */
+#define TS_HAS_OFFSETS 0x1
+
+/**
+ * @brief The tasksets of the file have a worst case execution time per task
+ */
+#define TS_HAS_WCETS 0x2
+
+/**
+ * @brief The tasksets of the file have a release jitter per task
+ */
+#define TS_HAS_JITTERS 0x4
+
+/**
+ * @brief A taskset as stored in the file, followed by its periods
+ */
+typedef struct ts_entry {
+    uint64_t id; /**< Id of the taskset */
+    uint32_t duration; /**< Ticks to simulate */
+    uint32_t tasks; /**< Number of tasks */
+} ts_entry_t;
+
+/**
+ * @brief A mapped taskset file
+ */
+typedef struct ts_file {
+    const uint8_t *data; /**< Start of the mapping */
+    uint64_t size; /**< Size of the file in bytes */
+    uint64_t count; /**< Number of tasksets */
+    uint32_t flags; /**< TS_HAS_OFFSETS, TS_HAS_WCETS and TS_HAS_JITTERS */
+    const uint64_t *index; /**< Position of every taskset in the file */
+} ts_file_t;
+
+/**
+ * @brief A taskset file being written
+ */
+typedef struct ts_writer {
+    FILE *file; /**< File written to */
+    uint32_t flags; /**< TS_HAS_OFFSETS, TS_HAS_WCETS and TS_HAS_JITTERS */
+    uint64_t count; /**< Number of tasksets written */
+    uint64_t capacity; /**< Number of positions index can hold */
+    uint64_t *index; /**< Position of every taskset written */
+    uint64_t position; /**< Position the next taskset is written to */
+} ts_writer_t;
+
+/**
+ * @brief Maps a taskset file and checks its header and index
+ *
+ * @param file Filled with the mapping
+ * @param path Path of the taskset file
+ * @return returns 0 on success; -1 if the file can't be read or is no taskset
+ * file of a version this code knows.
+ */
+int tsOpen(ts_file_t *file, const char *path);
+
+/**
+ * @brief Unmaps a taskset file
+ *
+ * @param file File opened with tsOpen()
+ */
+void tsClose(ts_file_t *file);
+
+/**
+ * @brief Finds a taskset of the file
+ *
+ * @param file File opened with tsOpen()
+ * @param index Number of the taskset, from 0 to file->count - 1
+ * @return The taskset, or NULL if it doesn't fit into the file
+ */
+const ts_entry_t *tsGet(const ts_file_t *file, uint64_t index);
+
+/**
+ * @brief Periods of a taskset, one per task
+ *
+ * @param entry Taskset returned by tsGet()
+ * @return The periods in ticks
+ */
+static inline const uint32_t *tsPeriods(const ts_entry_t *entry)
+{
+    return (const uint32_t *)(entry + 1);
+}
+
+/**
+ * @brief Offsets of a taskset, one per task
+ *
+ * @param file File the taskset is from
+ * @param entry Taskset returned by tsGet()
+ * @return The offsets in ticks, or NULL if the file has none
+ */
+const uint32_t *tsOffsets(const ts_file_t *file, const ts_entry_t *entry);
+
+/**
+ * @brief Worst case execution times of a taskset, one per task
+ *
+ * @param file File the taskset is from
+ * @param entry Taskset returned by tsGet()
+ * @return The worst case execution times in microseconds, or NULL if the file
+ * has none
+ */
+const uint32_t *tsWcets(const ts_file_t *file, const ts_entry_t *entry);
+
+/**
+ * @brief Release jitters of a taskset, one per task
+ *
+ * A task with a jitter is sporadic, its jobs are released up to this many
+ * ticks later than a period after the one before.
+ *
+ * @param file File the taskset is from
+ * @param entry Taskset returned by tsGet()
+ * @return The jitters in ticks, or NULL if the file has none
+ */
+const uint32_t *tsJitters(const ts_file_t *file, const ts_entry_t *entry);
+
+/**
+ * @brief Creates a taskset file
+ *
+ * @param writer Filled with the state of the file being written
+ * @param path Path of the taskset file, it is truncated
+ * @param flags TS_HAS_OFFSETS, TS_HAS_WCETS and TS_HAS_JITTERS if the
+ * tasksets have them
+ * @return returns 0 on success; on error, -1 is returned.
+ */
+int tsWriterOpen(ts_writer_t *writer, const char *path, uint32_t flags);
+
+/**
+ * @brief Appends a taskset to the file
+ *
+ * @param writer Writer opened with tsWriterOpen()
+ * @param id Id of the taskset
+ * @param duration Ticks to simulate
+ * @param tasks Number of tasks
+ * @param periods Period of every task
+ * @param offsets Offset of every task, ignored without TS_HAS_OFFSETS
+ * @param wcets Worst case execution time of every task, ignored without
+ * TS_HAS_WCETS
+ * @param jitters Release jitter of every task, ignored without
+ * TS_HAS_JITTERS
+ * @return returns 0 on success; on error, -1 is returned.
+ */
+int tsWriterAdd(ts_writer_t *writer, uint64_t id, uint32_t duration,
+                uint32_t tasks, const uint32_t *periods,
+                const uint32_t *offsets, const uint32_t *wcets,
+                const uint32_t *jitters);
+
+/**
+ * @brief Writes the index and the header and closes the file
+ *
+ * @param writer Writer opened with tsWriterOpen()
+ * @return Number of tasksets written, or -1 if writing failed
+ */
+long tsWriterClose(ts_writer_t *writer);
+
+/** @} */
+#endif
@@ -0,0 +1,270 @@
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "TraceBuffer.h"
+
+#define PRINT_CHECK                                                            \
+    fprintf(stderr, "[ERRNO: %s] %s:%d -> %s\n", strerror(errno),          \
+            __FILE__, __LINE__, __func__);
+
+#define TB_MAGIC "TBUF"
+#define TB_VERSION 1
+#define TB_BATCH 1024
+#define TB_IDLE_NS 1000000
+
+typedef struct tb_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+} tb_header_t;
+
+/* A slot is free for the producer reserving position pos when its sequence
+ * equals pos, and holds a record for the consumer when it equals pos + 1. */
+typedef struct tb_slot {
+    uint64_t sequence;
+    tb_record_t record;
+} tb_slot_t;
+
+static tb_slot_t tb_ring[TB_CAPACITY];
+static uint64_t tb_head = 0;
+static uint64_t tb_tail = 0;
+static uint64_t tb_dropped = 0;
+static int tb_ring_ready = 0;
+
+static pthread_t tb_thread;
+static FILE *tb_file = NULL;
+static int tb_running = 0;
+static long tb_written = 0;
+
+static void tbInitRing(void)
+{
+    uint64_t i;
+
+    for (i = 0; i < TB_CAPACITY; i++) {
+        tb_ring[i].sequence = i;
+    }
+    __atomic_store_n(&tb_ring_ready, 1, __ATOMIC_RELEASE);
+}
+
+void tbRecord(uint64_t timestamp, const void *list, uint32_t length,
+              uint32_t duration)
+{
+    tb_slot_t *slot;
+    uint64_t pos, seq;
+
+    /* The ring is set up by a constructor, but a record coming in before
+     * it ran is dropped rather than put into a slot that is not ready */
+    if (!__atomic_load_n(&tb_ring_ready, __ATOMIC_ACQUIRE)) {
+        __atomic_fetch_add(&tb_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    pos = __atomic_load_n(&tb_head, __ATOMIC_RELAXED);
+    for (;;) {
+        slot = &tb_ring[pos & (TB_CAPACITY - 1)];
+        seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+        if (seq == pos) {
+            if (__atomic_compare_exchange_n(&tb_head, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                break;
+            }
+            /* pos was reloaded by the failed exchange */
+        }
+        else if (seq < pos) {
+            /* Slot still holds a record of the previous lap, ring is full */
+            __atomic_fetch_add(&tb_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        else {
+            pos = __atomic_load_n(&tb_head, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->record.timestamp = timestamp;
+    slot->record.list = (uint32_t)(uintptr_t)list;
+    slot->record.length = length;
+    slot->record.duration = duration;
+    slot->record.dropped =
+        (uint32_t)__atomic_load_n(&tb_dropped, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+}
+
+/* Moves up to max records out of the ring, only ever called by one thread */
+static size_t tbTake(tb_record_t *records, size_t max)
+{
+    tb_slot_t *slot;
+    size_t count = 0;
+
+    while (count < max) {
+        slot = &tb_ring[tb_tail & (TB_CAPACITY - 1)];
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) !=
+            tb_tail + 1) {
+            break;
+        }
+
+        records[count++] = slot->record;
+        __atomic_store_n(&slot->sequence, tb_tail + TB_CAPACITY,
+                         __ATOMIC_RELEASE);
+        tb_tail++;
+    }
+
+    return count;
+}
+
+static void tbWrite(tb_record_t *records, size_t count)
+{
+    if (fwrite(records, sizeof(tb_record_t), count, tb_file) != count) {
+        PRINT_CHECK
+    }
+    tb_written += count;
+}
+
+static void *tbDrainThread(void *args)
+{
+    static tb_record_t records[TB_BATCH];
+    struct timespec idle = { .tv_sec = 0, .tv_nsec = TB_IDLE_NS };
+    size_t count;
+
+    (void)args;
+
+    while (__atomic_load_n(&tb_running, __ATOMIC_ACQUIRE)) {
+        count = tbTake(records, TB_BATCH);
+        if (count) {
+            tbWrite(records, count);
+        }
+        else {
+            nanosleep(&idle, NULL);
+        }
+    }
+
+    /* Whatever was recorded until the thread was told to stop */
+    while ((count = tbTake(records, TB_BATCH))) {
+        tbWrite(records, count);
+    }
+
+    return NULL;
+}
+
+static void __attribute__((constructor)) tbConstructor(void)
+{
+    tbInitRing();
+}
+
+int tbInit(const char *filename)
+{
+    tb_header_t header = { .version = TB_VERSION,
+                           .record_size = sizeof(tb_record_t),
+                           .reserved = 0
+                         };
+    sigset_t all, old;
+
+    if (tb_file) {
+        fprintf(stderr, "Trace buffer already initialised\n");
+        return -1;
+    }
+
+    tb_file = fopen(filename, "wb");
+    if (!tb_file) {
+        PRINT_CHECK
+        return -1;
+    }
+
+    memcpy(header.magic, TB_MAGIC, sizeof(header.magic));
+    if (fwrite(&header, sizeof(header), 1, tb_file) != 1) {
+        PRINT_CHECK
+        fclose(tb_file);
+        tb_file = NULL;
+        return -1;
+    }
+
+    tb_written = 0;
+    __atomic_store_n(&tb_running, 1, __ATOMIC_RELEASE);
+
+    /* The thread inherits the signal mask, block everything so the tick and
+     * context switch signals of the port are never delivered to it */
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    errno = pthread_create(&tb_thread, NULL, tbDrainThread, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (errno) {
+        PRINT_CHECK
+        __atomic_store_n(&tb_running, 0, __ATOMIC_RELEASE);
+        fclose(tb_file);
+        tb_file = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+long tbDeinit(void)
+{
+    if (!tb_file) {
+        return -1;
+    }
+
+    __atomic_store_n(&tb_running, 0, __ATOMIC_RELEASE);
+    pthread_join(tb_thread, NULL);
+
+    fclose(tb_file);
+    tb_file = NULL;
+
+    if (tb_dropped) {
+        fprintf(stderr, "Trace buffer full, %lu records dropped\n",
+                tbGetDropped());
+    }
+
+    return tb_written;
+}
+
+uint64_t tbGetRecorded(void)
+{
+    return __atomic_load_n(&tb_head, __ATOMIC_RELAXED);
+}
+
+unsigned long tbGetDropped(void)
+{
+    return (unsigned long)__atomic_load_n(&tb_dropped, __ATOMIC_RELAXED);
+}
+
+long tbDecode(const char *filename, FILE *out, const char *label)
+{
+    tb_header_t header;
+    tb_record_t record;
+    long count = 0;
+    FILE *in;
+
+    in = fopen(filename, "rb");
+    if (!in) {
+        PRINT_CHECK
+        return -1;
+    }
+
+    if (fread(&header, sizeof(header), 1, in) != 1 ||
+        memcmp(header.magic, TB_MAGIC, sizeof(header.magic)) ||
+        header.version != TB_VERSION ||
+        header.record_size != sizeof(tb_record_t)) {
+        fprintf(stderr, "'%s' is not a trace file\n", filename);
+        fclose(in);
+        return -1;
+    }
+
+    while (fread(&record, sizeof(record), 1, in) == 1) {
+        fprintf(out, "%s:%u\n", label, record.duration);
+        count++;
+    }
+
+    fclose(in);
+
+    return count;
+}
@@ -0,0 +1,138 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "TraceClock.h"
+
+#if TB_CLOCK_USE_TSC
+#include <cpuid.h>
+#endif
+
+#define TB_CALIBRATION_NS 20000000
+#define TB_BASELINE_RUNS 10000
+
+int tb_clock_tsc = 0;
+
+static double tb_ns_per_tick = 1.0;
+static uint64_t tb_tick_origin = 0;
+static uint64_t tb_ns_origin = 0;
+static double tb_overhead = 0.0;
+
+#if TB_CLOCK_USE_TSC
+static int tbTscUsable(void)
+{
+    unsigned eax, ebx, ecx, edx;
+    const char *env = getenv("TRACE_CLOCK");
+
+    if (env && strcmp(env, "monotonic") == 0) {
+        return 0;
+    }
+
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) ||
+        eax < 0x80000007) {
+        return 0;
+    }
+
+    /* rdtscp */
+    __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx);
+    if (!(edx & (1U << 27))) {
+        return 0;
+    }
+
+    /* Invariant TSC, ticks at a constant rate in all power states */
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1U << 8)) != 0;
+}
+
+static void tbCalibrate(void)
+{
+    struct timespec wait = { .tv_sec = 0, .tv_nsec = TB_CALIBRATION_NS };
+    uint64_t ns_start, ns_stop, tick_start, tick_stop;
+    double rate;
+
+    tb_clock_tsc = 1;
+    ns_start = tbClockMonotonic();
+    tick_start = tbClockStart();
+    nanosleep(&wait, NULL);
+    ns_stop = tbClockMonotonic();
+    tick_stop = tbClockStart();
+
+    rate = (double)(tick_stop - tick_start) / (double)(ns_stop - ns_start);
+
+    /* Anything outside 100 MHz to 10 GHz means the counter isn't usable */
+    if (rate < 0.1 || rate > 10.0) {
+        tb_clock_tsc = 0;
+        return;
+    }
+
+    tb_ns_per_tick = 1.0 / rate;
+    tb_tick_origin = tick_start;
+    tb_ns_origin = ns_start;
+}
+#endif
+
+static void tbMeasureOverhead(void)
+{
+    uint64_t start, stop, best = UINT64_MAX;
+
+    /* The quickest empty interval is the cost of reading the clock itself,
+     * anything slower was disturbed */
+    for (int i = 0; i < TB_BASELINE_RUNS; i++) {
+        start = tbClockStart();
+        stop = tbClockStop();
+        if (stop - start < best) {
+            best = stop - start;
+        }
+    }
+
+    tb_overhead = (double)best * tb_ns_per_tick;
+}
+
+static void __attribute__((constructor)) tbClockInit(void)
+{
+#if TB_CLOCK_USE_TSC
+    if (tbTscUsable()) {
+        tbCalibrate();
+    }
+#endif
+    tbMeasureOverhead();
+}
+
+uint32_t tbClockElapsedNs(uint64_t start, uint64_t stop)
+{
+    double ns = (double)(stop - start) * tb_ns_per_tick - tb_overhead;
+
+    if (ns <= 0.0) {
+        return 0;
+    }
+    if (ns >= (double)UINT32_MAX) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)(ns + 0.5);
+}
+
+uint64_t tbClockToNs(uint64_t timestamp)
+{
+    if (!tb_clock_tsc) {
+        return timestamp;
+    }
+    return tb_ns_origin +
+           (uint64_t)((double)(int64_t)(timestamp - tb_tick_origin) *
+                      tb_ns_per_tick);
+}
+
+const char *tbClockGetName(void)
+{
+    return tb_clock_tsc ? "tsc" : "monotonic";
+}
+
+double tbClockGetFrequency(void)
+{
+    return 1e9 / tb_ns_per_tick;
+}
+
+double tbClockGetOverheadNs(void)
+{
+    return tb_overhead;
+}
@@ -0,0 +1,158 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "TraceHistogram.h"
+
+/* 2^TB_SUB_BITS buckets per power of two, values below 2^(TB_SUB_BITS + 1)
+ * have a bucket each */
+#define TB_SUB_BITS 5
+#define TB_SUB_COUNT (1U << TB_SUB_BITS)
+#define TB_BUCKETS ((32 - TB_SUB_BITS + 1) * TB_SUB_COUNT)
+
+typedef struct tb_histogram {
+    const void *list;
+    uint64_t count;
+    uint32_t max;
+    uint32_t max_length;
+    uint64_t buckets[TB_BUCKETS];
+} tb_histogram_t;
+
+static tb_histogram_t tb_histograms[TB_HISTOGRAM_LISTS];
+
+/* Owner of the histogram shared by the lists that didn't get one of their
+ * own, NULL already means that a histogram is unused */
+static const char tb_claiming;
+
+static unsigned tbBucketOf(uint32_t value)
+{
+    unsigned exponent;
+
+    if (value < 2 * TB_SUB_COUNT) {
+        return value;
+    }
+
+    exponent = 31 - (unsigned)__builtin_clz(value);
+    return (exponent - TB_SUB_BITS + 1) * TB_SUB_COUNT +
+           ((value >> (exponent - TB_SUB_BITS)) - TB_SUB_COUNT);
+}
+
+static uint32_t tbHighestOf(unsigned bucket)
+{
+    unsigned shift;
+
+    if (bucket < 2 * TB_SUB_COUNT) {
+        return bucket;
+    }
+
+    shift = bucket / TB_SUB_COUNT - 1;
+    return (uint32_t)((((uint64_t)(TB_SUB_COUNT + bucket % TB_SUB_COUNT) + 1)
+                       << shift) - 1);
+}
+
+static void tbUpdateMax(uint32_t *max, uint32_t value)
+{
+    uint32_t current = __atomic_load_n(max, __ATOMIC_RELAXED);
+
+    while (value > current &&
+           !__atomic_compare_exchange_n(max, &current, value, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static tb_histogram_t *tbFind(const void *list)
+{
+    unsigned start = (unsigned)(((uintptr_t)list >> 4) % TB_HISTOGRAM_LISTS);
+    unsigned i = start;
+    const void *owner, *expected;
+
+    /* Open addressing, the last free slot is kept for lists that don't fit */
+    do {
+        owner = __atomic_load_n(&tb_histograms[i].list, __ATOMIC_ACQUIRE);
+        if (owner == list) {
+            return &tb_histograms[i];
+        }
+        if (owner == NULL && i != TB_HISTOGRAM_LISTS - 1) {
+            expected = NULL;
+            if (__atomic_compare_exchange_n(&tb_histograms[i].list,
+                                            &expected, list, 0,
+                                            __ATOMIC_ACQ_REL,
+                                            __ATOMIC_ACQUIRE) ||
+                expected == list) {
+                return &tb_histograms[i];
+            }
+        }
+        i = (i + 1) % TB_HISTOGRAM_LISTS;
+    } while (i != start);
+
+    /* Shared by all lists that didn't get a slot of their own */
+    expected = NULL;
+    __atomic_compare_exchange_n(&tb_histograms[TB_HISTOGRAM_LISTS - 1].list,
+                                &expected, (const void *)&tb_claiming, 0,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return &tb_histograms[TB_HISTOGRAM_LISTS - 1];
+}
+
+void tbHistogramRecord(const void *list, uint32_t length, uint32_t duration)
+{
+    tb_histogram_t *histogram = tbFind(list);
+
+    __atomic_fetch_add(&histogram->buckets[tbBucketOf(duration)], 1,
+                       __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+    tbUpdateMax(&histogram->max, duration);
+    tbUpdateMax(&histogram->max_length, length);
+}
+
+static uint32_t tbPercentile(const tb_histogram_t *histogram, uint64_t count,
+                             unsigned permille)
+{
+    /* Smallest value that at least permille of the durations don't exceed */
+    uint64_t rank = (count * permille + 999) / 1000;
+    uint64_t seen = 0;
+    unsigned bucket;
+
+    for (bucket = 0; bucket < TB_BUCKETS; bucket++) {
+        seen += histogram->buckets[bucket];
+        if (seen >= rank) {
+            return tbHighestOf(bucket) < histogram->max ?
+                   tbHighestOf(bucket) : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+int tbHistogramGetSummaries(tb_summary_t *summaries, int max)
+{
+    const tb_histogram_t *histogram;
+    const void *list;
+    uint64_t count;
+    int n = 0;
+
+    for (unsigned i = 0; i < TB_HISTOGRAM_LISTS && n < max; i++) {
+        histogram = &tb_histograms[i];
+        list = __atomic_load_n(&histogram->list, __ATOMIC_ACQUIRE);
+        count = __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+        if (list == NULL || count == 0) {
+            continue;
+        }
+
+        summaries[n].list = list == (const void *)&tb_claiming ? NULL : list;
+        summaries[n].count = count;
+        summaries[n].max_length = histogram->max_length;
+        summaries[n].p50 = tbPercentile(histogram, count, 500);
+        summaries[n].p90 = tbPercentile(histogram, count, 900);
+        summaries[n].p99 = tbPercentile(histogram, count, 990);
+        summaries[n].p999 = tbPercentile(histogram, count, 999);
+        summaries[n].max = histogram->max;
+        n++;
+    }
+
+    return n;
+}
+
+void tbHistogramReset(void)
+{
+    memset(tb_histograms, 0, sizeof(tb_histograms));
+}
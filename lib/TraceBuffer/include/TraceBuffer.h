@@ -0,0 +1,129 @@
+/**
+ * @file TraceBuffer.h
+ * @date 17 October 2026
+ * @brief A preallocated, lock-free binary ring buffer for timing records that
+ * is drained to a file by a background thread.
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#ifndef __TRACEBUFFER_H__
+#define __TRACEBUFFER_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @defgroup tb_trace Trace Buffer API
+ *
+ * @brief Records timing measurements without formatting or blocking the
+ * code being measured
+ *
+ * tbRecord() only reserves a slot of a preallocated ring with an atomic
+ * compare-and-swap and copies a fixed size record into it, so it can be called
+ * from any thread or signal handler. If the ring is full the record is dropped
+ * and counted instead of waiting. A background thread started by tbInit()
+ * writes the records to a file in their binary form, which tbDecode() turns
+ * back into text.
+ *
+ * @{
+ */
+
+/**
+ * @brief Number of records the ring can hold, a power of two
+ */
+#define TB_CAPACITY (1U << 16)
+
+/**
+ * @brief Label the decoder prints in front of each duration by default
+ */
+#define TB_DEFAULT_LABEL "TIME"
+
+/**
+ * @brief A single timing record, written to the trace file as is
+ */
+typedef struct tb_record {
+    uint64_t timestamp; /**< CLOCK_MONOTONIC time at the start, in ns */
+    uint32_t list; /**< Identifies the list, the low 32 bits of its address */
+    uint32_t length; /**< Number of items in the list afterwards */
+    uint32_t duration; /**< Duration of the operation in ns */
+    uint32_t dropped; /**< Records dropped before this one, ring was full */
+} tb_record_t;
+
+/**
+ * @brief Stores a record in the ring
+ *
+ * Safe to call before tbInit(), the records are then kept until the ring is
+ * drained.
+ *
+ * @param timestamp CLOCK_MONOTONIC time at the start of the operation in ns
+ * @param list Address of the list the operation was performed on
+ * @param length Number of items in the list after the operation
+ * @param duration Duration of the operation in ns
+ */
+void tbRecord(uint64_t timestamp, const void *list, uint32_t length,
+              uint32_t duration);
+
+/**
+ * @brief Starts the background thread draining the ring into a file
+ *
+ * The file starts with a small header followed by the records. The thread
+ * blocks all signals so it never runs the handlers of the FreeRTOS port.
+ *
+ * @param filename Path of the trace file, it is truncated
+ * @return returns 0 on success; on error, -1 is returned.
+ */
+int tbInit(const char *filename);
+
+/**
+ * @brief Drains the remaining records, stops the background thread and closes
+ * the trace file
+ *
+ * @return Number of records written to the file, or -1 if tbInit() was not
+ * successfully called
+ */
+long tbDeinit(void);
+
+/**
+ * @brief Number of records stored in the ring so far
+ *
+ * Dropped records are not counted, so if the ring is drained by a single
+ * tbInit() of the process this is the index of the next record in the trace
+ * file, which lets the records of a part of the program be found again.
+ *
+ * @return The number of stored records
+ */
+uint64_t tbGetRecorded(void);
+
+/**
+ * @brief Number of records that were dropped because the ring was full
+ *
+ * @return The number of dropped records
+ */
+unsigned long tbGetDropped(void);
+
+/**
+ * @brief Decodes a trace file into one "LABEL:DURATION" line per record
+ *
+ * @param filename Path of the trace file
+ * @param out Stream the lines are written to
+ * @param label Label printed in front of each duration, eg. TB_DEFAULT_LABEL
+ * @return Number of records decoded, or -1 if the file is not a valid trace
+ */
+long tbDecode(const char *filename, FILE *out, const char *label);
+
+/** @} */
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file TraceClock.h
+ * @date 17 October 2026
+ * @brief Timing backend for tracing short code sections, using the time stamp
+ * counter where it is reliable and clock_gettime() otherwise.
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#ifndef __TRACECLOCK_H__
+#define __TRACECLOCK_H__
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @defgroup tb_clock Trace Clock API
+ *
+ * @brief Reads timestamps around a code section and converts their
+ * difference to ns
+ *
+ * On x86 the time stamp counter is read with rdtsc/rdtscp fenced by lfence,
+ * which takes a few ns and resolves single cycles. It is only used if the CPU
+ * reports an invariant TSC and rdtscp, its rate is calibrated against
+ * CLOCK_MONOTONIC when the program starts. Elsewhere, or with the environment
+ * variable TRACE_CLOCK set to "monotonic", clock_gettime(CLOCK_MONOTONIC) is
+ * used. In both cases the time an empty start/stop pair takes is measured at
+ * startup and subtracted from every interval.
+ *
+ * @{
+ */
+
+#ifndef TB_CLOCK_USE_TSC
+#if defined(__x86_64__) || defined(__i386__)
+#define TB_CLOCK_USE_TSC 1
+#else
+#define TB_CLOCK_USE_TSC 0
+#endif
+#endif
+
+/**
+ * @brief Set at startup if the time stamp counter is used, do not modify
+ */
+extern int tb_clock_tsc;
+
+/**
+ * @brief CLOCK_MONOTONIC time in ns
+ */
+static inline uint64_t tbClockMonotonic(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Reads the clock at the start of a section, the earlier instructions
+ * have completed before it is read
+ *
+ * @return Raw timestamp, see tbClockElapsedNs() and tbClockToNs()
+ */
+static inline uint64_t tbClockStart(void)
+{
+#if TB_CLOCK_USE_TSC
+    if (tb_clock_tsc) {
+        uint32_t lo, hi;
+
+        __asm__ volatile("lfence\n\trdtsc" : "=a"(lo), "=d"(hi) : : "memory");
+        return ((uint64_t)hi << 32) | lo;
+    }
+#endif
+    return tbClockMonotonic();
+}
+
+/**
+ * @brief Reads the clock at the end of a section, the section has completed
+ * before it is read and later instructions don't start before
+ *
+ * @return Raw timestamp, see tbClockElapsedNs() and tbClockToNs()
+ */
+static inline uint64_t tbClockStop(void)
+{
+#if TB_CLOCK_USE_TSC
+    if (tb_clock_tsc) {
+        uint32_t lo, hi;
+
+        __asm__ volatile("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi) : : "rcx",
+                         "memory");
+        return ((uint64_t)hi << 32) | lo;
+    }
+#endif
+    return tbClockMonotonic();
+}
+
+/**
+ * @brief Duration between two raw timestamps, without the measured overhead
+ * of reading the clock
+ *
+ * @param start Timestamp from tbClockStart()
+ * @param stop Timestamp from tbClockStop()
+ * @return Duration in ns, 0 if it was below the overhead, UINT32_MAX if it
+ * doesn't fit
+ */
+uint32_t tbClockElapsedNs(uint64_t start, uint64_t stop);
+
+/**
+ * @brief Converts a raw timestamp to CLOCK_MONOTONIC ns
+ *
+ * @param timestamp Timestamp from tbClockStart() or tbClockStop()
+ * @return The CLOCK_MONOTONIC time of the timestamp in ns
+ */
+uint64_t tbClockToNs(uint64_t timestamp);
+
+/**
+ * @brief Name of the backend in use, "tsc" or "monotonic"
+ *
+ * @return The name
+ */
+const char *tbClockGetName(void);
+
+/**
+ * @brief Rate of the raw timestamps
+ *
+ * @return Timestamps per second
+ */
+double tbClockGetFrequency(void);
+
+/**
+ * @brief Overhead subtracted from every interval
+ *
+ * @return The overhead in ns
+ */
+double tbClockGetOverheadNs(void);
+
+/** @} */
+#endif
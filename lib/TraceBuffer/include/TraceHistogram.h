@@ -0,0 +1,89 @@
+/**
+ * @file TraceHistogram.h
+ * @date 17 October 2026
+ * @brief Log-bucketed (HDR style) latency histograms kept per list, for
+ * summarising millions of timing measurements in a few lines.
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#ifndef __TRACEHISTOGRAM_H__
+#define __TRACEHISTOGRAM_H__
+
+#include <stdint.h>
+
+/**
+ * @defgroup tb_histogram Trace Histogram API
+ *
+ * @brief Accumulates durations into one histogram per list
+ *
+ * Values below 64 are counted exactly, above that every power of two is
+ * split into 32 buckets, so a reported percentile is within about 3% of
+ * the exact one while a histogram takes a fixed 7 KiB. Recording is a lookup
+ * of the list and an atomic increment, it can be called from any thread or
+ * signal handler.
+ *
+ * @{
+ */
+
+/**
+ * @brief Number of lists that get a histogram of their own, the durations of
+ * any further lists are counted together under the list NULL
+ */
+#define TB_HISTOGRAM_LISTS 32
+
+/**
+ * @brief Summary of the histogram of one list
+ */
+typedef struct tb_summary {
+    const void *list; /**< The list, NULL for lists that did not fit */
+    uint64_t count; /**< Number of recorded durations */
+    uint32_t max_length; /**< Longest the list was after an insertion */
+    uint32_t p50; /**< Percentiles in ns, upper bound of their bucket */
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max; /**< Exact maximum in ns */
+} tb_summary_t;
+
+/**
+ * @brief Adds a duration to the histogram of a list
+ *
+ * @param list Address of the list the operation was performed on
+ * @param length Number of items in the list after the operation
+ * @param duration Duration of the operation in ns
+ */
+void tbHistogramRecord(const void *list, uint32_t length, uint32_t duration);
+
+/**
+ * @brief Summarises the histograms of all lists that recorded anything
+ *
+ * @param summaries Array the summaries are written to
+ * @param max Number of entries summaries can hold
+ * @return Number of summaries written
+ */
+int tbHistogramGetSummaries(tb_summary_t *summaries, int max);
+
+/**
+ * @brief Empties the histograms of all lists
+ *
+ * Must not be called while durations are recorded, eg. between two runs of
+ * the scheduler.
+ */
+void tbHistogramReset(void);
+
+/** @} */
+#endif
@@ -12,44 +12,492 @@
 for the insertion of one timer item please define TRACE_INSERTS in list.c */
 #define TRACE_TASKS
 
+/* uncomment if TRACE_BUFFER is defined in list.c. The insertion times are
+then drained into TRACE_BUFFER_FILE while the simulation runs and printed from
+it when the simulation has ended, so printing does not disturb them */
+// #define TRACE_BUFFER
+#define TRACE_BUFFER_FILE "timing.trace"
+
+/* uncomment if TRACE_HISTOGRAM is defined in list.c to print percentiles of
+the insertion times per list at the end of the simulation */
+// #define TRACE_HISTOGRAM
+
+/* CPU affinity of the sweep workers */
+#define _GNU_SOURCE
+
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <limits.h>
+#include <dirent.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "semphr.h"
 #include "task.h"
 
+#include "TraceBuffer.h"
+#include "TraceClock.h"
+#include "TraceHistogram.h"
+#include "TasksetFile.h"
+#include "ResultSink.h"
+
 /* general settings with constants */
 #define mainGENERIC_PRIORITY (tskIDLE_PRIORITY)
 #define mainGENERIC_STACK_SIZE ((unsigned short)25600)
 #define PRIORITY_WORKER 1
 #define PRIORITY_KILLER 2
 #define PRINT_NUMBER_OF_PERIODS_PER_LINE 20
+#define PINGPONG_DEFAULT_ROUNDS 100000
+#define TICKCOST_DEFAULT_TICKS 100000
+#define WHEELCHECK_DEFAULT_ROUNDS 1000000
+#define WHEELCHECK_ITEMS 64
+#define CACHE_LINE_SIZE 64
+#define SWEEP_LINE_SIZE 4096
+#define GENERATOR_DEFAULT_MIN_PERIOD 10
+#define GENERATOR_DEFAULT_MAX_PERIOD 1000
+#define GENERATOR_DEFAULT_DURATION 2000
+#define BUSY_LOOP_CHUNK_US 10
+#define BUSY_LOOP_CALIBRATION_US 10000
+#define BUSY_LOOP_CALIBRATION_ROUNDS 5
+#define RESULTS_FILE_VARIABLE "RESULTS_FILE"
+#define HEAP_STATS_CLASSES 32
+#define RESULT_HEADER "RESULT:taskset,id,duration,tasks,jobs,seconds,misses,lateness\n"
 
-/* we support up to 1000 tasks, prepare data structures */
-UBaseType_t tasksJobs[1000];
-UBaseType_t tasksPeriods[1000];
-TickType_t startTimes[1000];
+/* how late the jobs of a task are released, in ticks after the intended
+release. Kept online in constant time, the variance as sum of squared
+differences from the mean (Welford) */
+typedef struct {
+    UBaseType_t samples; /* releases measured, the last job may still wait */
+    TickType_t min;
+    TickType_t max;
+    double mean;
+    double squares;
+    UBaseType_t misses; /* ended a period or more after their release */
+} LatenessStats_t;
+
+/* state of a task of the taskset, the job counting of a task only touches its
+own cache line */
+typedef struct {
+    TickType_t startTime;
+    TickType_t period;
+    UBaseType_t jobs;
+    double utilization; /* share of the CPU, only known for generated tasks */
+    uint32_t wcet; /* microseconds every job spends in the busy loop */
+    LatenessStats_t lateness;
+    TickType_t offset; /* ticks until the first release */
+    TickType_t jitter; /* sporadic releases up to this much after the period */
+    uint64_t random; /* state of the jitter of the task */
+} __attribute__((aligned(CACHE_LINE_SIZE))) SimulationTask_t;
+
+/* the tasks are allocated as the taskset header says */
+SimulationTask_t *simulationTasks = NULL;
 UBaseType_t simulationId = ULONG_MAX;
 TickType_t simulationDuration = INT_MAX;
 UBaseType_t tasksCount = ULONG_MAX;
 
+/* names of the delayed list orderings, indexed by listORDER_XXX */
+const char *delayedListOrders[] = { "list", "heap", "wheel", "buckets", "skip" };
+UBaseType_t delayedListOrder = configDELAYED_LIST_ORDER;
+
+/* remember the ordering the delayed tasks are kept in for the output, with
+configUSE_SKIP_LISTS every sorted list is kept as a skip list */
+void noteDelayedListOrder(UBaseType_t order)
+{
+#if (configUSE_SKIP_LISTS == 1)
+    if (order == listORDER_SORTED_LIST) {
+        order = listORDER_SKIP_LIST;
+    }
+#endif
+    delayedListOrder = order;
+}
+
+/* order the delayed tasks as named by an ORDER argument, pdFALSE if there is
+no such ordering or it can't be selected */
+BaseType_t selectDelayedListOrder(const char *name)
+{
+#if (configUSE_DELAYED_LIST_ORDER_SELECTION == 1)
+    for (UBaseType_t i = 0; i < 5; i++) {
+        if (strcmp(delayedListOrders[i], name) == 0 &&
+            xTaskSetDelayedListOrder(i) == pdPASS) {
+            noteDelayedListOrder(i);
+            return pdTRUE;
+        }
+    }
+#else
+    (void)name;
+#endif
+    return pdFALSE;
+}
+
+/* in batch mode every taskset only prints its result line */
+BaseType_t batchMode = pdFALSE;
+
+/* index of the first insertion time of the current taskset in the trace */
+uint64_t traceStart = 0;
+
+/* splitmix64, so a seed gives the same numbers everywhere */
+uint64_t nextRandom(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* iterations of busyLoop() per microsecond, see calibrateBusyLoop() */
+double busyLoopsPerUs = 0.0;
+
+void busyLoop(UBaseType_t iterations)
+{
+    for (volatile UBaseType_t i = 0; i < iterations; i++) {
+    }
+}
+
+/* the fastest of some rounds, a round that was preempted only takes longer */
+void calibrateBusyLoop(void)
+{
+    UBaseType_t iterations = 1000;
+    uint64_t fastest = UINT64_MAX;
+
+    /* grow the round until it takes long enough to be measured */
+    for (;;) {
+        uint64_t start = tbClockMonotonic();
+        busyLoop(iterations);
+        if (tbClockMonotonic() - start >= BUSY_LOOP_CALIBRATION_US * 1000) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    for (UBaseType_t i = 0; i < BUSY_LOOP_CALIBRATION_ROUNDS; i++) {
+        uint64_t start = tbClockMonotonic();
+        busyLoop(iterations);
+        uint64_t duration = tbClockMonotonic() - start;
+        if (duration < fastest) {
+            fastest = duration;
+        }
+    }
+
+    busyLoopsPerUs = iterations * 1000.0 / fastest;
+}
+
+/* spend wcet microseconds of CPU time. The loop is counted, not timed, so
+the time the task is preempted doesn't count. Between the chunks the port can
+process the ticks that came due, the Ucontext port only does that when a
+critical section is left */
+void executeJob(uint32_t wcet)
+{
+    UBaseType_t remaining = wcet * busyLoopsPerUs;
+    UBaseType_t chunk = BUSY_LOOP_CHUNK_US * busyLoopsPerUs;
+
+    while (remaining > 0) {
+        UBaseType_t iterations = remaining < chunk ? remaining : chunk;
+        busyLoop(iterations);
+        remaining -= iterations;
+
+        taskENTER_CRITICAL();
+        taskEXIT_CRITICAL();
+    }
+}
+
 /* default task */
 void vDefaultTask(void *pvParameters)
 {
-    UBaseType_t taskId = (UBaseType_t)pvParameters;
-    tasksJobs[taskId] = 0;
-    startTimes[taskId] = xTaskGetTickCount();
+    SimulationTask_t *task = (SimulationTask_t *)pvParameters;
+    task->jobs = 0;
+    task->startTime = xTaskGetTickCount();
+    if (task->offset > 0) {
+        vTaskDelayUntil(&task->startTime, task->offset);
+    }
     for (;;) {
-        /* just increase jobcounter and wait */
-        tasksJobs[taskId] = tasksJobs[taskId] + 1;
-        vTaskDelayUntil(&startTimes[taskId], tasksPeriods[taskId]);
+        /* increase jobcounter, work and wait */
+        task->jobs = task->jobs + 1;
+        if (task->wcet > 0) {
+            executeJob(task->wcet);
+        }
+        if (xTaskGetTickCount() - task->startTime >= task->period) {
+            task->lateness.misses++;
+        }
+
+        /* a sporadic task is released at least a period after its last job */
+        TickType_t interArrival = task->period;
+        if (task->jitter > 0) {
+            interArrival += nextRandom(&task->random) % (task->jitter + 1);
+        }
+        vTaskDelayUntil(&task->startTime, interArrival);
+
+        /* startTime is now the intended release of the next job */
+        TickType_t lateness = xTaskGetTickCount() - task->startTime;
+        LatenessStats_t *stats = &task->lateness;
+        double delta = lateness - stats->mean;
+
+        stats->samples++;
+        if (stats->samples == 1 || lateness < stats->min) {
+            stats->min = lateness;
+        }
+        if (lateness > stats->max) {
+            stats->max = lateness;
+        }
+        stats->mean += delta / stats->samples;
+        stats->squares += delta * (lateness - stats->mean);
+    }
+}
+
+/* ping-pong benchmark, two tasks wake each other so every round takes two
+context switches. Blocked tasks created before them show whether the cost
+depends on the number of tasks */
+UBaseType_t pingPongRounds = PINGPONG_DEFAULT_ROUNDS;
+UBaseType_t pingPongBlockedTasks = 0;
+TaskHandle_t pingPongTasks[2];
+
+void vBlockedTask(void *pvParameters)
+{
+    (void)pvParameters;
+    vTaskSuspend(NULL);
+}
+
+void vPingTask(void *pvParameters)
+{
+    (void)pvParameters;
+    uint64_t start = tbClockMonotonic();
+
+    for (UBaseType_t i = 0; i < pingPongRounds; i++) {
+        xTaskNotifyGive(pingPongTasks[1]);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    uint64_t duration = tbClockMonotonic() - start;
+
+    prints("\n");
+    prints("Rounds:                 %lu\n", pingPongRounds);
+    prints("Blocked tasks:          %lu\n", pingPongBlockedTasks);
+    prints("Context switches:       %lu\n", 2 * pingPongRounds);
+    prints("Time per switch:        %.0f ns\n",
+           (double)duration / (2.0 * pingPongRounds));
+    prints("\n");
+
+    vTaskEndScheduler();
+}
+
+void vPongTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xTaskNotifyGive(pingPongTasks[0]);
+    }
+}
+
+/* tick benchmark, the blocked tasks wait in the delayed list */
+UBaseType_t tickCostTicks = TICKCOST_DEFAULT_TICKS;
+UBaseType_t tickCostBlockedTasks = 0;
+
+void vSleepingTask(void *pvParameters)
+{
+    /* wake up well after the benchmark, every task at a tick of its own */
+    vTaskDelay(2 * tickCostTicks + 1 + (UBaseType_t)pvParameters);
+    vTaskSuspend(NULL);
+}
+
+/* times the ticks the tick handler of the port hands to the kernel, the
+critical section keeps the ticks of the port pending meanwhile */
+void vTickCostTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    taskENTER_CRITICAL();
+    uint64_t start = tbClockMonotonic();
+    for (UBaseType_t i = 0; i < tickCostTicks; i++) {
+        (void)xTaskIncrementTick();
+    }
+    uint64_t duration = tbClockMonotonic() - start;
+    taskEXIT_CRITICAL();
+
+    prints("\n");
+    prints("Ticks:                  %lu\n", tickCostTicks);
+    prints("Blocked tasks:          %lu\n", tickCostBlockedTasks);
+    prints("Time per tick:          %.1f ns\n",
+           (double)duration / tickCostTicks);
+    prints("\n");
+
+    vTaskEndScheduler();
+}
+
+#if (listUSE_ORDERS == 1)
+/* ticks until the earliest item linked into a wheel list falls due, 0 if the
+wheel has fallen behind it */
+TickType_t earliestWheelItem(const ListItem_t *items, const List_t *list,
+                             TickType_t now)
+{
+    TickType_t earliest = portMAX_DELAY;
+
+    for (UBaseType_t i = 0; i < WHEELCHECK_ITEMS; i++) {
+        TickType_t delta = listGET_LIST_ITEM_VALUE(&items[i]) - now;
+
+        if (listLIST_ITEM_CONTAINER(&items[i]) != list) {
+            continue;
+        }
+        if (delta > portMAX_DELAY / 2) {
+            delta = 0;
+        }
+        if (delta < earliest) {
+            earliest = delta;
+        }
+    }
+
+    return earliest;
+}
+
+/* link and unlink random items of a timing wheel and let random times pass,
+xListWheelTicksUntilDue() must never report the earliest item later than it
+is, returns the number of checks that failed */
+UBaseType_t checkTimingWheel(UBaseType_t rounds, uint64_t seed)
+{
+    static ListWheel_t wheel;
+    static ListItem_t items[WHEELCHECK_ITEMS];
+    List_t list;
+    TickType_t now = (TickType_t)nextRandom(&seed);
+    UBaseType_t failures = 0;
+
+    vListInitialise(&list);
+    vListInitialiseWheel(&list, &wheel, now);
+    for (UBaseType_t i = 0; i < WHEELCHECK_ITEMS; i++) {
+        vListInitialiseItem(&items[i]);
+        listSET_LIST_ITEM_OWNER(&items[i], &items[i]);
+    }
+
+    for (UBaseType_t round = 0; round < rounds; round++) {
+        uint64_t random = nextRandom(&seed);
+        ListItem_t *item = &items[random % WHEELCHECK_ITEMS];
+        TickType_t span = (TickType_t)1 << ((random >> 8) % 20);
+        TickType_t ticks;
+
+        /* deltas from 0 to 2^19 ticks, so every level below gets used and
+        items are relinked whole rotations away */
+        if (listLIST_ITEM_CONTAINER(item) == NULL) {
+            listSET_LIST_ITEM_VALUE(item, now + (TickType_t)(random >> 32) % span);
+            vListInsert(&list, item);
+        }
+        else if (random & 0x80) {
+            (void)uxListRemove(item);
+        }
+        else {
+            /* check while the wheel lags behind, then take the due items */
+            now += (TickType_t)(random >> 32) % (span < 4096 ? span : 4096);
+            ticks = xListWheelTicksUntilDue(&list, now);
+            if (ticks > earliestWheelItem(items, &list, now)) {
+                failures++;
+            }
+            while ((item = pvListWheelGetDueOwner(&list, now)) != NULL) {
+                (void)uxListRemove(item);
+            }
+        }
+
+        ticks = xListWheelTicksUntilDue(&list, now);
+        if (ticks > earliestWheelItem(items, &list, now)) {
+            failures++;
+        }
+    }
+
+    return failures;
+}
+#endif
+
+#ifdef TRACE_TASKS
+/* list and job stats of the simulation */
+void printTaskStats(void)
+{
+    ListStats_t listStats;
+    xTickStats tickStats;
+    vTaskGetDelayedListStats(&listStats);
+    vPortGetTickStats(&tickStats);
+
+    prints("\n");
+    prints("Simulation ended after %d ticks, task stats:\n",
+           xTaskGetTickCount());
+    prints("\n");
+    prints("Delayed list:           %s, %u items, %u skip links\n",
+           delayedListOrders[listStats.uxOrder],
+           listStats.uxNumberOfItems, listStats.uxSkipLinks);
+    prints("List item size:         %u bytes (%u for ordering)\n",
+           (unsigned)listStats.xItemSize, (unsigned)listStats.xItemOrderSize);
+    prints("List size:              %u bytes (%u storage)\n",
+           (unsigned)listStats.xListSize, (unsigned)listStats.xStorageSize);
+    prints("Ticks:                  %lu processed, %lu deferred, %lu lost\n",
+           (unsigned long)tickStats.ullProcessed,
+           (unsigned long)tickStats.ullDeferred,
+           (unsigned long)tickStats.ullLost);
+    prints("\n");
+#if (configUSE_SLAB_HEAP == 1)
+    SlabStats_t slabStats[HEAP_STATS_CLASSES];
+    UBaseType_t classes = uxPortGetSlabStats(slabStats, HEAP_STATS_CLASSES);
+
+    prints("Heap blocks per used size class (0: malloc):\n");
+    prints("\n");
+    prints("Size\tCarved\tIn use\tFree\tAllocs\t\tWaste\tOverflows\n");
+    for (UBaseType_t i = 0; i < classes; i++) {
+        SlabStats_t *stats = &slabStats[i];
+        uint64_t blockBytes = stats->ullAllocations * stats->xBlockSize;
+
+        if (stats->ullAllocations == 0) {
+            continue;
+        }
+
+        prints("%u\t%u\t%u\t%u\t%lu\t\t%.1f%%\t%lu\n",
+               (unsigned)stats->xBlockSize, (unsigned)stats->xBlocksCarved,
+               (unsigned)stats->xBlocksInUse,
+               stats->xBlockSize ?
+               (unsigned)(stats->xBlocksCarved - stats->xBlocksInUse) : 0,
+               (unsigned long)stats->ullAllocations,
+               blockBytes ? 100.0 * (blockBytes - stats->ullRequestedBytes) /
+               blockBytes : 0.0,
+               (unsigned long)stats->ullOverflows);
+    }
+    prints("\n");
+#endif
+#ifdef TRACE_HISTOGRAM
+    tb_summary_t summaries[TB_HISTOGRAM_LISTS];
+    int lists = tbHistogramGetSummaries(summaries, TB_HISTOGRAM_LISTS);
+
+    prints("Insertion times in ns per list:\n");
+    prints("\n");
+    prints("List\t\tLength\tCount\t\tp50\tp90\tp99\tp99.9\tMax\n");
+    for (int i = 0; i < lists; i++) {
+        prints("%p\t%u\t%lu\t\t%u\t%u\t%u\t%u\t%u\n",
+               summaries[i].list, summaries[i].max_length,
+               (unsigned long)summaries[i].count, summaries[i].p50,
+               summaries[i].p90, summaries[i].p99, summaries[i].p999,
+               summaries[i].max);
     }
+    prints("\n");
+#endif
+    prints("Release lateness in ticks per task:\n");
+    prints("\n");
+    prints("Number\t\tPeriod\t\tWCET\tOffset\tJitter\tJobs\tMin\tMax\tMean\tStddev\tMisses\n");
+    for (UBaseType_t i = 0; i < tasksCount; i++) {
+        LatenessStats_t *stats = &simulationTasks[i].lateness;
+
+        prints("%lu\t\t%u\t\t%u\t%u\t%u\t%lu\t%u\t%u\t%.2f\t%.2f\t%lu\n",
+               (i + 1), simulationTasks[i].period, simulationTasks[i].wcet,
+               simulationTasks[i].offset, simulationTasks[i].jitter,
+               simulationTasks[i].jobs, stats->min,
+               stats->max, stats->mean,
+               stats->samples > 1 ?
+               sqrt(stats->squares / (stats->samples - 1)) : 0.0,
+               stats->misses);
+    }
+    prints("\n");
 }
+#endif
 
 /* end simulator task */
 void vKillSystem(void *pvParameters)
@@ -60,22 +508,830 @@ void vKillSystem(void *pvParameters)
 
     /* print stats prior exit */
 #ifdef TRACE_TASKS
-    prints("\n");
-    prints("Simulation ended after %d ticks, task stats:\n",
-           xTaskGetTickCount());
-    prints("\n");
-    prints("Number\t\tPeriod\t\tJobs\n");
-    for (unsigned short i = 0; i < tasksCount; i++) {
-        prints("%d\t\t%d\t\t%d\n", (i + 1), tasksPeriods[i],
-               tasksJobs[i]);
+    if (!batchMode) {
+        printTaskStats();
     }
-    prints("\n");
 #endif
 
     /* stop scheduler */
     vTaskEndScheduler();
 }
 
+/* tasks with all counters and stats cleared, NULL if out of memory */
+SimulationTask_t *allocateTasks(UBaseType_t count)
+{
+    SimulationTask_t *tasks = aligned_alloc(CACHE_LINE_SIZE,
+                                            count * sizeof(SimulationTask_t));
+    if (tasks != NULL) {
+        memset(tasks, 0, count * sizeof(SimulationTask_t));
+    }
+    return tasks;
+}
+
+/* read a taskset file and allocate its tasks, returns the error code */
+BaseType_t loadTaskset(const char *path)
+{
+    FILE *input_file = fopen(path, "r");
+    BaseType_t errorcode = 0;
+
+    if (input_file == NULL) {
+        return 3;
+    }
+
+    /* header, then one period per task */
+    if (fscanf(input_file, "%lu", &simulationId) != 1 ||
+        fscanf(input_file, "%u", &simulationDuration) != 1 ||
+        fscanf(input_file, "%lu", &tasksCount) != 1 ||
+        tasksCount == 0 || tasksCount == ULONG_MAX) {
+        errorcode = 4;
+    }
+    else {
+        simulationTasks = allocateTasks(tasksCount);
+        if (simulationTasks == NULL) {
+            errorcode = 4;
+        }
+    }
+
+    /* one task per line, execution time, offset and jitter are optional */
+    for (UBaseType_t i = 0; errorcode == 0 && i < tasksCount; i++) {
+        char line[64];
+        int fields = EOF;
+
+        while (fields == EOF && fgets(line, sizeof(line), input_file) != NULL) {
+            fields = sscanf(line, "%u %u %u %u", &simulationTasks[i].period,
+                            &simulationTasks[i].wcet,
+                            &simulationTasks[i].offset,
+                            &simulationTasks[i].jitter);
+        }
+        if (fields < 1) {
+            errorcode = 4;
+        }
+    }
+
+    fclose(input_file);
+    return errorcode;
+}
+
+/* release the tasks of the taskset loaded before */
+void unloadTaskset(void)
+{
+    free(simulationTasks);
+    simulationTasks = NULL;
+    simulationId = ULONG_MAX;
+    simulationDuration = INT_MAX;
+    tasksCount = ULONG_MAX;
+}
+
+/* create the worker tasks of the loaded taskset and the killer task, the busy
+loop is only calibrated if the tasks will run and some job has to execute */
+void createSimulationTasks(BaseType_t run)
+{
+#ifdef TRACE_BUFFER
+    traceStart = tbGetRecorded();
+#endif
+    for (UBaseType_t i = 0; run && busyLoopsPerUs == 0.0 && i < tasksCount;
+         i++) {
+        if (simulationTasks[i].wcet > 0) {
+            calibrateBusyLoop();
+        }
+    }
+
+    /* create worker tasks, the jitter of a task depends on the taskset id and
+    its number only */
+    for (UBaseType_t i = 0; i < tasksCount; i++) {
+        simulationTasks[i].random = simulationId * tasksCount + i;
+        xTaskCreate(vDefaultTask, "Default Task",
+                    mainGENERIC_STACK_SIZE * 2, &simulationTasks[i],
+                    PRIORITY_WORKER, NULL);
+    }
+
+    /* create killer task */
+    xTaskCreate(vKillSystem, "Ending Task", mainGENERIC_STACK_SIZE * 2, NULL,
+                PRIORITY_KILLER, NULL);
+}
+
+/* jobs and misses of all tasks and the latest release */
+void sumTasks(UBaseType_t *jobs, UBaseType_t *misses, TickType_t *lateness)
+{
+    *jobs = 0;
+    *misses = 0;
+    *lateness = 0;
+    for (UBaseType_t i = 0; i < tasksCount; i++) {
+        *jobs += simulationTasks[i].jobs;
+        *misses += simulationTasks[i].lateness.misses;
+        if (simulationTasks[i].lateness.max > *lateness) {
+            *lateness = simulationTasks[i].lateness.max;
+        }
+    }
+}
+
+/* start collecting results if RESULTS_FILE is set, a worker of a sweep uses
+a file of its own */
+void openResults(BaseType_t worker)
+{
+    const char *path = getenv(RESULTS_FILE_VARIABLE);
+
+    if (path == NULL || path[0] == '\0') {
+        return;
+    }
+    if (rsOpen(path, worker) != 0) {
+        prints("Can't collect results for %s\n", path);
+    }
+}
+
+void closeResults(void)
+{
+    if (rsIsOpen()) {
+        rsClose();
+    }
+}
+
+/* drain the insertion times of all tasksets into TRACE_BUFFER_FILE, a worker
+of a sweep uses a file of its own. The run records say which of the records
+belong to a taskset */
+void startTrace(BaseType_t worker)
+{
+#ifdef TRACE_BUFFER
+    char path[PATH_MAX];
+
+    if (worker < 0) {
+        snprintf(path, sizeof(path), "%s", TRACE_BUFFER_FILE);
+    }
+    else {
+        snprintf(path, sizeof(path), "%s.%ld", TRACE_BUFFER_FILE, worker);
+    }
+    if (tbInit(path) != 0) {
+        prints("Can't write insertion times to %s\n", path);
+    }
+#else
+    (void)worker;
+#endif
+}
+
+void stopTrace(void)
+{
+#ifdef TRACE_BUFFER
+    (void)tbDeinit();
+#endif
+}
+
+/* records of the simulation that just ended: the run, every task and the
+insertion times per list */
+void writeResults(const char *name, double seconds)
+{
+    UBaseType_t jobs, misses;
+    TickType_t lateness;
+    xTickStats tickStats;
+
+    if (!rsIsOpen()) {
+        return;
+    }
+
+    sumTasks(&jobs, &misses, &lateness);
+    vPortGetTickStats(&tickStats);
+    rsBegin("run");
+    rsString("taskset", name);
+    rsUnsigned("id", simulationId);
+    rsUnsigned("duration", simulationDuration);
+    rsUnsigned("tasks", tasksCount);
+    rsUnsigned("jobs", jobs);
+    rsDouble("seconds", seconds);
+    rsUnsigned("misses", misses);
+    rsUnsigned("lateness", lateness);
+    rsString("order", delayedListOrders[delayedListOrder]);
+    rsString("time", configUSE_VIRTUAL_TIME ? "virtual" : "real");
+    rsString("context_switch", portCONTEXT_SWITCH);
+    rsUnsigned("ticks_processed", tickStats.ullProcessed);
+    rsUnsigned("ticks_deferred", tickStats.ullDeferred);
+    rsUnsigned("ticks_lost", tickStats.ullLost);
+#ifdef TRACE_BUFFER
+    rsUnsigned("trace_first", traceStart);
+    rsUnsigned("trace_records", tbGetRecorded() - traceStart);
+#endif
+    rsEnd();
+
+    for (UBaseType_t i = 0; i < tasksCount; i++) {
+        SimulationTask_t *task = &simulationTasks[i];
+
+        rsBegin("task");
+        rsString("taskset", name);
+        rsUnsigned("number", i + 1);
+        rsUnsigned("period", task->period);
+        rsUnsigned("wcet", task->wcet);
+        rsUnsigned("offset", task->offset);
+        rsUnsigned("jitter", task->jitter);
+        rsUnsigned("jobs", task->jobs);
+        rsUnsigned("lateness_min", task->lateness.min);
+        rsUnsigned("lateness_max", task->lateness.max);
+        rsDouble("lateness_mean", task->lateness.mean);
+        rsDouble("lateness_stddev", task->lateness.samples > 1 ?
+                 sqrt(task->lateness.squares /
+                      (task->lateness.samples - 1)) : 0.0);
+        rsUnsigned("misses", task->lateness.misses);
+        rsEnd();
+    }
+
+#ifdef TRACE_HISTOGRAM
+    tb_summary_t summaries[TB_HISTOGRAM_LISTS];
+    int lists = tbHistogramGetSummaries(summaries, TB_HISTOGRAM_LISTS);
+    char list[32];
+
+    for (int i = 0; i < lists; i++) {
+        snprintf(list, sizeof(list), "%p", summaries[i].list);
+        rsBegin("insertions");
+        rsString("taskset", name);
+        rsString("list", list);
+        rsUnsigned("max_length", summaries[i].max_length);
+        rsUnsigned("count", summaries[i].count);
+        rsUnsigned("p50", summaries[i].p50);
+        rsUnsigned("p90", summaries[i].p90);
+        rsUnsigned("p99", summaries[i].p99);
+        rsUnsigned("p999", summaries[i].p999);
+        rsUnsigned("max", summaries[i].max);
+        rsEnd();
+    }
+#endif
+}
+
+/* run the loaded taskset to its end and print one result line, the kernel
+is reset afterwards so the next taskset starts from scratch */
+void runLoadedTaskset(const char *name)
+{
+    UBaseType_t jobs;
+    UBaseType_t misses;
+    TickType_t lateness;
+
+    createSimulationTasks(pdTRUE);
+
+    uint64_t start = tbClockMonotonic();
+    vTaskStartScheduler();
+    uint64_t duration = tbClockMonotonic() - start;
+    vTaskResetKernel();
+
+    sumTasks(&jobs, &misses, &lateness);
+    writeResults(name, duration / 1e9);
+#ifdef TRACE_HISTOGRAM
+    /* every taskset gets histograms of its own */
+    tbHistogramReset();
+#endif
+    prints("RESULT:%s,%lu,%u,%lu,%lu,%.3f,%lu,%u\n", name, simulationId,
+           simulationDuration, tasksCount, jobs, duration / 1e9, misses,
+           lateness);
+    fflush(stdout);
+
+    unloadTaskset();
+}
+
+/* take a taskset from a binary taskset file, returns the error code */
+BaseType_t loadContainedTaskset(const ts_file_t *file, uint64_t index)
+{
+    const ts_entry_t *entry = tsGet(file, index);
+
+    if (entry == NULL || entry->tasks == 0) {
+        return 4;
+    }
+
+    simulationTasks = allocateTasks(entry->tasks);
+    if (simulationTasks == NULL) {
+        return 4;
+    }
+    simulationId = entry->id;
+    simulationDuration = entry->duration;
+    tasksCount = entry->tasks;
+
+    const uint32_t *periods = tsPeriods(entry);
+    const uint32_t *wcets = tsWcets(file, entry);
+    const uint32_t *offsets = tsOffsets(file, entry);
+    const uint32_t *jitters = tsJitters(file, entry);
+    for (UBaseType_t i = 0; i < tasksCount; i++) {
+        simulationTasks[i].period = periods[i];
+        simulationTasks[i].wcet = wcets != NULL ? wcets[i] : 0;
+        simulationTasks[i].offset = offsets != NULL ? offsets[i] : 0;
+        simulationTasks[i].jitter = jitters != NULL ? jitters[i] : 0;
+    }
+
+    return 0;
+}
+
+/* run one taskset of a binary taskset file, returns the error code */
+BaseType_t runContainedTaskset(const ts_file_t *file, const char *path,
+                               uint64_t index)
+{
+    BaseType_t errorcode = loadContainedTaskset(file, index);
+    char name[PATH_MAX + 32];
+
+    snprintf(name, sizeof(name), "%s:%lu", path, index);
+    if (errorcode != 0) {
+        prints("RESULT:%s,error,%ld\n", name, errorcode);
+        unloadTaskset();
+        return errorcode;
+    }
+
+    runLoadedTaskset(name);
+    return 0;
+}
+
+/* run the taskset file at path, or every taskset of a binary taskset file,
+returns the error code of loading them */
+BaseType_t runBatchTaskset(const char *path)
+{
+    BaseType_t errorcode = 0;
+    ts_file_t file;
+
+    if (tsOpen(&file, path) == 0) {
+        for (uint64_t i = 0; i < file.count; i++) {
+            if (runContainedTaskset(&file, path, i) != 0) {
+                errorcode = 4;
+            }
+        }
+        tsClose(&file);
+        return errorcode;
+    }
+
+    errorcode = loadTaskset(path);
+    if (errorcode != 0) {
+        prints("RESULT:%s,error,%ld\n", path, errorcode);
+        unloadTaskset();
+        return errorcode;
+    }
+
+    runLoadedTaskset(path);
+    return 0;
+}
+
+/* period distributions of the generator */
+const char *periodDistributions[] = { "loguniform", "harmonic" };
+
+uint64_t generatorState;
+
+/* uniform in [0, 1) */
+double nextUniform(void)
+{
+    return (nextRandom(&generatorState) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* create a taskset in memory instead of loading it: the utilizations are
+drawn with UUniFast, the periods log-uniform or as power of two multiples of
+minPeriod between minPeriod and maxPeriod, the execution times follow */
+BaseType_t generateTaskset(uint64_t seed, UBaseType_t tasks,
+                           double utilization, UBaseType_t distribution,
+                           TickType_t minPeriod, TickType_t maxPeriod,
+                           TickType_t duration)
+{
+    double remaining = utilization;
+
+    simulationTasks = allocateTasks(tasks);
+    if (simulationTasks == NULL) {
+        return 4;
+    }
+    simulationId = seed;
+    simulationDuration = duration;
+    tasksCount = tasks;
+    generatorState = seed;
+
+    for (UBaseType_t i = 0; i < tasks; i++) {
+        /* UUniFast */
+        if (i + 1 < tasks) {
+            double next = remaining * pow(nextUniform(), 1.0 / (tasks - i - 1));
+            simulationTasks[i].utilization = remaining - next;
+            remaining = next;
+        }
+        else {
+            simulationTasks[i].utilization = remaining;
+        }
+
+        if (distribution == 0) {
+            double logMin = log(minPeriod);
+            double logMax = log(maxPeriod + 1.0);
+            simulationTasks[i].period =
+                (TickType_t)exp(logMin + nextUniform() * (logMax - logMin));
+            if (simulationTasks[i].period > maxPeriod) {
+                simulationTasks[i].period = maxPeriod;
+            }
+        }
+        else {
+            UBaseType_t doublings = 0;
+            while ((minPeriod << (doublings + 1)) <= maxPeriod) {
+                doublings++;
+            }
+            simulationTasks[i].period =
+                minPeriod << (nextRandom(&generatorState) % (doublings + 1));
+        }
+
+        /* every job takes the utilization of its period */
+        simulationTasks[i].wcet = simulationTasks[i].utilization *
+                                  simulationTasks[i].period *
+                                  (1000000.0 / configTICK_RATE_HZ) + 0.5;
+    }
+
+    return 0;
+}
+
+/* generate and run count tasksets with the seeds seed to seed + count - 1 */
+void runGenerated(uint64_t seed, UBaseType_t count, UBaseType_t tasks,
+                  double utilization, UBaseType_t distribution,
+                  TickType_t minPeriod, TickType_t maxPeriod,
+                  TickType_t duration)
+{
+    char name[64];
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        snprintf(name, sizeof(name), "%s:%lu",
+                 periodDistributions[distribution], seed + i);
+        if (generateTaskset(seed + i, tasks, utilization, distribution,
+                            minPeriod, maxPeriod, duration) != 0) {
+            prints("RESULT:%s,error,4\n", name);
+            unloadTaskset();
+            continue;
+        }
+        runLoadedTaskset(name);
+    }
+}
+
+/* only regular files of a directory are tasksets, not the trace files the
+batch and sweep modes write */
+int isTasksetEntry(const struct dirent *entry)
+{
+#ifdef TRACE_BUFFER
+    if (strncmp(entry->d_name, TRACE_BUFFER_FILE,
+                strlen(TRACE_BUFFER_FILE)) == 0) {
+        return 0;
+    }
+#endif
+    return entry->d_type == DT_REG || entry->d_type == DT_UNKNOWN;
+}
+
+/* collect the tasksets of a directory in name order, the ones listed in a
+manifest file with one path per line or a single text taskset, returns NULL if
+path can't be read */
+char **listTasksets(const char *path, UBaseType_t *count)
+{
+    struct stat pathStat;
+    char line[PATH_MAX];
+    char **paths = NULL;
+    UBaseType_t size = 0;
+
+    *count = 0;
+    if (stat(path, &pathStat) != 0) {
+        return NULL;
+    }
+
+    if (S_ISDIR(pathStat.st_mode)) {
+        struct dirent **entries;
+        int entriesCount = scandir(path, &entries, isTasksetEntry, alphasort);
+
+        if (entriesCount < 0) {
+            return NULL;
+        }
+        paths = malloc((entriesCount + 1) * sizeof(char *));
+        for (int i = 0; i < entriesCount; i++) {
+            snprintf(line, sizeof(line), "%s/%s", path, entries[i]->d_name);
+            if (paths != NULL) {
+                paths[(*count)++] = strdup(line);
+            }
+            free(entries[i]);
+        }
+        free(entries);
+    }
+    else if (loadTaskset(path) == 0) {
+        /* a text taskset is no list of tasksets */
+        unloadTaskset();
+        paths = malloc(sizeof(char *));
+        if (paths != NULL) {
+            paths[(*count)++] = strdup(path);
+        }
+    }
+    else {
+        unloadTaskset();
+
+        FILE *manifest = fopen(path, "r");
+        if (manifest == NULL) {
+            return NULL;
+        }
+        paths = malloc(sizeof(char *));
+        while (paths != NULL && fgets(line, sizeof(line), manifest) != NULL) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] == '\0' || line[0] == '#') {
+                continue;
+            }
+            if (*count + 1 >= size) {
+                size = size ? 2 * size : 64;
+                char **grown = realloc(paths, size * sizeof(char *));
+                if (grown == NULL) {
+                    break;
+                }
+                paths = grown;
+            }
+            paths[(*count)++] = strdup(line);
+        }
+        fclose(manifest);
+    }
+
+    return paths;
+}
+
+void freeTasksets(char **paths, UBaseType_t count)
+{
+    for (UBaseType_t i = 0; i < count; i++) {
+        free(paths[i]);
+    }
+    free(paths);
+}
+
+/* run every taskset one after another, returns the number of failures */
+UBaseType_t runBatch(const char *path)
+{
+    UBaseType_t failures = 0;
+    UBaseType_t count;
+    ts_file_t file;
+
+    /* a binary taskset file is no list of tasksets */
+    if (tsOpen(&file, path) == 0) {
+        tsClose(&file);
+        return runBatchTaskset(path) != 0;
+    }
+
+    char **paths = listTasksets(path, &count);
+    if (paths == NULL) {
+        return 1;
+    }
+    for (UBaseType_t i = 0; i < count; i++) {
+        failures += runBatchTaskset(paths[i]) != 0;
+    }
+    freeTasksets(paths, count);
+
+    return failures;
+}
+
+/* write text tasksets into one binary taskset file, returns the error code,
+4 if some of them were skipped */
+BaseType_t convertTasksets(const char *path, const char *output)
+{
+    BaseType_t errorcode = 0;
+    UBaseType_t count;
+    ts_writer_t writer;
+    char **paths = listTasksets(path, &count);
+
+    if (paths == NULL) {
+        return 3;
+    }
+    if (tsWriterOpen(&writer, output,
+                     TS_HAS_OFFSETS | TS_HAS_WCETS | TS_HAS_JITTERS) != 0) {
+        freeTasksets(paths, count);
+        return 3;
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        uint32_t *columns = NULL;
+
+        if (loadTaskset(paths[i]) == 0) {
+            columns = malloc(4 * tasksCount * sizeof(uint32_t));
+        }
+        if (columns == NULL) {
+            prints("Skipped %s: Invalid taskset definition\n", paths[i]);
+            errorcode = 4;
+            unloadTaskset();
+            continue;
+        }
+
+        /* periods, offsets, execution times and jitters one after another */
+        uint32_t *periods = columns;
+        uint32_t *offsets = periods + tasksCount;
+        uint32_t *wcets = offsets + tasksCount;
+        uint32_t *jitters = wcets + tasksCount;
+        for (UBaseType_t j = 0; j < tasksCount; j++) {
+            periods[j] = simulationTasks[j].period;
+            offsets[j] = simulationTasks[j].offset;
+            wcets[j] = simulationTasks[j].wcet;
+            jitters[j] = simulationTasks[j].jitter;
+        }
+        if (tsWriterAdd(&writer, simulationId, simulationDuration, tasksCount,
+                        periods, offsets, wcets, jitters) != 0) {
+            errorcode = 3;
+        }
+
+        free(columns);
+        unloadTaskset();
+    }
+
+    long written = tsWriterClose(&writer);
+    if (written < 0) {
+        errorcode = 3;
+    }
+    else {
+        prints("Converted %ld tasksets into %s\n", written, output);
+    }
+    freeTasksets(paths, count);
+
+    return errorcode;
+}
+
+/* output of a sweep worker, only complete lines are passed on so the lines of
+the workers don't mix */
+typedef struct {
+    size_t length;
+    char line[SWEEP_LINE_SIZE];
+} SweepOutput_t;
+
+/* run tasksets from the shared queue on one CPU until none are left, the
+output goes into the pipe to the parent. The queue holds the taskset files of
+paths, or the tasksets of file if it is a binary taskset file */
+void runSweepWorker(char **paths, const ts_file_t *file, UBaseType_t count,
+                    UBaseType_t *next, UBaseType_t worker, int cpu)
+{
+    UBaseType_t failures = 0;
+    cpu_set_t cpus;
+
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        perror("sched_setaffinity");
+    }
+    openResults(worker);
+    startTrace(worker);
+
+    for (;;) {
+        UBaseType_t i = __atomic_fetch_add(next, 1, __ATOMIC_RELAXED);
+        if (i >= count) {
+            break;
+        }
+        if (file->data != NULL) {
+            failures += runContainedTaskset(file, paths[0], i) != 0;
+        }
+        else {
+            failures += runBatchTaskset(paths[i]) != 0;
+        }
+    }
+
+    stopTrace();
+    closeResults();
+    fflush(stdout);
+    _exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/* pass the complete lines of a worker on, all of them once it has ended */
+void forwardSweepOutput(SweepOutput_t *output, BaseType_t ended)
+{
+    size_t length = output->length;
+
+    if (!ended && length < SWEEP_LINE_SIZE) {
+        while (length > 0 && output->line[length - 1] != '\n') {
+            length--;
+        }
+    }
+
+    fwrite(output->line, 1, length, stdout);
+    output->length -= length;
+    memmove(output->line, output->line + length, output->length);
+}
+
+/* run the tasksets on workers forked from this process, each pinned to one
+of the allowed CPUs, returns the number of failed workers */
+UBaseType_t runSweep(const char *path, UBaseType_t workers)
+{
+    UBaseType_t failures = 0;
+    UBaseType_t running;
+    UBaseType_t count;
+    cpu_set_t allowed;
+    int cpus[CPU_SETSIZE];
+    int cpusCount = 0;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus[cpusCount++] = cpu;
+            }
+        }
+    }
+    if (cpusCount == 0) {
+        cpus[cpusCount++] = 0;
+    }
+    if (workers == 0) {
+        workers = cpusCount;
+    }
+
+    /* the tasksets of a binary taskset file are spread over the workers too */
+    ts_file_t file = { 0 };
+    char **paths;
+
+    if (tsOpen(&file, path) == 0) {
+        count = file.count;
+        paths = malloc(sizeof(char *));
+        if (paths != NULL) {
+            paths[0] = strdup(path);
+        }
+    }
+    else {
+        paths = listTasksets(path, &count);
+    }
+    if (paths == NULL) {
+        tsClose(&file);
+        return 1;
+    }
+
+    /* index of the next taskset, shared with the workers */
+    UBaseType_t *next = mmap(NULL, sizeof(UBaseType_t),
+                             PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    struct pollfd *pipes = calloc(workers, sizeof(struct pollfd));
+    SweepOutput_t *outputs = calloc(workers, sizeof(SweepOutput_t));
+    pid_t *pids = calloc(workers, sizeof(pid_t));
+
+    if (next == MAP_FAILED || pipes == NULL || outputs == NULL ||
+        pids == NULL) {
+        freeTasksets(paths, file.data != NULL ? 1 : count);
+        tsClose(&file);
+        return 1;
+    }
+    *next = 0;
+
+    /* nothing buffered may be written by the workers again */
+    fflush(stdout);
+
+    for (running = 0; running < workers; running++) {
+        int fds[2];
+
+        if (pipe(fds) != 0) {
+            break;
+        }
+        pids[running] = fork();
+        if (pids[running] == 0) {
+            for (UBaseType_t i = 0; i < running; i++) {
+                close(pipes[i].fd);
+            }
+            close(fds[0]);
+            dup2(fds[1], STDOUT_FILENO);
+            close(fds[1]);
+            runSweepWorker(paths, &file, count, next, running,
+                           cpus[running % cpusCount]);
+        }
+        close(fds[1]);
+        if (pids[running] < 0) {
+            close(fds[0]);
+            break;
+        }
+        pipes[running].fd = fds[0];
+        pipes[running].events = POLLIN;
+    }
+    if (running < workers) {
+        /* the workers that started still do all tasksets */
+        perror("sweep");
+        failures++;
+    }
+    workers = running;
+
+    /* merge the output of the workers line by line */
+    while (running > 0) {
+        if (poll(pipes, workers, -1) < 0) {
+            continue;
+        }
+        for (UBaseType_t i = 0; i < workers; i++) {
+            if (pipes[i].revents == 0) {
+                continue;
+            }
+            ssize_t length = read(pipes[i].fd,
+                                  outputs[i].line + outputs[i].length,
+                                  SWEEP_LINE_SIZE - outputs[i].length);
+            if (length > 0) {
+                outputs[i].length += length;
+                forwardSweepOutput(&outputs[i], pdFALSE);
+            }
+            else {
+                forwardSweepOutput(&outputs[i], pdTRUE);
+                close(pipes[i].fd);
+                pipes[i].fd = -1;
+                running--;
+            }
+        }
+    }
+    fflush(stdout);
+
+    for (UBaseType_t i = 0; i < workers; i++) {
+        int status;
+
+        if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS) {
+            failures++;
+        }
+    }
+
+    /* one file with the results of all workers */
+    const char *results = getenv(RESULTS_FILE_VARIABLE);
+    if (results != NULL && results[0] != '\0' &&
+        rsMerge(results, workers) < 0) {
+        failures++;
+    }
+
+    munmap(next, sizeof(UBaseType_t));
+    free(pids);
+    free(outputs);
+    free(pipes);
+    freeTasksets(paths, file.data != NULL ? 1 : count);
+    tsClose(&file);
+
+    return failures;
+}
+
 /* help message and error code handling */
 void printHelp(BaseType_t errorcode)
 {
@@ -92,11 +1348,50 @@ void printHelp(BaseType_t errorcode)
         case 4:
             prints("\nError: Invalid taskset definition\n");
             break;
+        case 5:
+            prints("\nError: Invalid delayed list order\n");
+            break;
+        case 6:
+            prints("\nError: Invalid generator parameters\n");
+            break;
     }
 
-    prints("\nUsage:    FreeRTOS_Emulator MODE TASKSET\n\n");
+    prints("\nUsage:    FreeRTOS_Emulator MODE TASKSET [ORDER]\n\n");
     prints("          MODE      1 or 0 (whether run taskset or not)\n");
     prints("          TASKSET   path to filename containing taskset information\n");
+    prints("          ORDER     list, heap, buckets or skip, ordering of the delayed tasks\n");
+    prints("                    (needs configUSE_DELAYED_LIST_ORDER_SELECTION)\n");
+    prints("\n          FreeRTOS_Emulator decode TRACEFILE [LABEL]\n\n");
+    prints("          TRACEFILE binary timing trace to print as LABEL:NS lines\n");
+    prints("\n          FreeRTOS_Emulator pingpong [ROUNDS [TASKS]]\n\n");
+    prints("          ROUNDS    number of task ping-pongs to time the context switch with\n");
+    prints("          TASKS     number of blocked tasks created before the ping-pong tasks\n");
+    prints("\n          FreeRTOS_Emulator tickcost [TICKS [TASKS]]\n\n");
+    prints("          TICKS     number of ticks to time the kernel tick with\n");
+    prints("          TASKS     number of delayed tasks created before\n");
+#if (listUSE_ORDERS == 1)
+    prints("\n          FreeRTOS_Emulator wheelcheck [ROUNDS [SEED]]\n\n");
+    prints("          ROUNDS    random insertions and time steps the timing wheel is\n");
+    prints("                    checked with\n");
+#endif
+    prints("\n          FreeRTOS_Emulator batch TASKSETS [ORDER]\n\n");
+    prints("          TASKSETS  directory of taskset files, file listing one per line\n");
+    prints("                    or binary taskset file, all run in one process, one\n");
+    prints("                    RESULT line each\n");
+    prints("\n          FreeRTOS_Emulator sweep TASKSETS [WORKERS [ORDER]]\n\n");
+    prints("          WORKERS   number of processes pinned to one CPU each that run the\n");
+    prints("                    tasksets of TASKSETS, all allowed CPUs by default\n");
+    prints("\n          FreeRTOS_Emulator generate SEED COUNT TASKS UTILIZATION\n");
+    prints("                    [PERIODS [MIN MAX [DURATION]]]\n\n");
+    prints("          SEED      seed of the first of COUNT tasksets generated in memory\n");
+    prints("          TASKS     number of tasks, their utilizations are drawn with UUniFast\n");
+    prints("                    and add up to UTILIZATION\n");
+    prints("          PERIODS   loguniform or harmonic periods from MIN to MAX ticks\n");
+    prints("                    (default loguniform %d %d), DURATION ticks (default %d)\n",
+           GENERATOR_DEFAULT_MIN_PERIOD, GENERATOR_DEFAULT_MAX_PERIOD,
+           GENERATOR_DEFAULT_DURATION);
+    prints("\n          FreeRTOS_Emulator convert TASKSETS OUTPUT\n\n");
+    prints("          OUTPUT    binary taskset file the text tasksets are written into\n");
     prints("\nExample:  FreeRTOS_Emulator 1 ../taskset.txt\n\n");
 }
 
@@ -106,61 +1401,196 @@ int main(int argc, char *argv[])
     BaseType_t runnable = pdFALSE;
     BaseType_t errorcode = 0;
 
-    /* initialize values for arrays */
-    for (UBaseType_t i = 0; i < 1000; i++) {
-        tasksJobs[i] = 0;
-        tasksPeriods[i] = 0;
+    noteDelayedListOrder(configDELAYED_LIST_ORDER);
+
+    /* decode binary timing trace */
+    if ((argc == 3 || argc == 4) && strcmp("decode", argv[1]) == 0) {
+        if (tbDecode(argv[2], stdout,
+                     argc == 4 ? argv[3] : TB_DEFAULT_LABEL) < 0) {
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    /* context switch benchmark */
+    if ((argc >= 2 && argc <= 4) && strcmp("pingpong", argv[1]) == 0) {
+        if (argc >= 3) {
+            pingPongRounds = strtoul(argv[2], NULL, 10);
+            if (pingPongRounds == 0) {
+                printHelp(1);
+                return EXIT_FAILURE;
+            }
+        }
+        if (argc == 4) {
+            pingPongBlockedTasks = strtoul(argv[3], NULL, 10);
+        }
+
+        prints("\n");
+        prints("Context switch:         %s\n",
+               portCONTEXT_SWITCH);
+        for (UBaseType_t i = 0; i < pingPongBlockedTasks; i++) {
+            xTaskCreate(vBlockedTask, "Blocked Task", mainGENERIC_STACK_SIZE,
+                        NULL, PRIORITY_WORKER, NULL);
+        }
+        xTaskCreate(vPingTask, "Ping Task", mainGENERIC_STACK_SIZE, NULL,
+                    PRIORITY_WORKER, &pingPongTasks[0]);
+        xTaskCreate(vPongTask, "Pong Task", mainGENERIC_STACK_SIZE, NULL,
+                    PRIORITY_WORKER, &pingPongTasks[1]);
+        vTaskStartScheduler();
+        return EXIT_SUCCESS;
+    }
+
+    /* tick benchmark */
+    if ((argc >= 2 && argc <= 4) && strcmp("tickcost", argv[1]) == 0) {
+        if (argc >= 3) {
+            tickCostTicks = strtoul(argv[2], NULL, 10);
+            if (tickCostTicks == 0) {
+                printHelp(1);
+                return EXIT_FAILURE;
+            }
+        }
+        if (argc == 4) {
+            tickCostBlockedTasks = strtoul(argv[3], NULL, 10);
+        }
+
+        prints("\n");
+        prints("Context switch:         %s\n",
+               portCONTEXT_SWITCH);
+        prints("Delayed list order:     %s\n",
+               delayedListOrders[delayedListOrder]);
+        for (UBaseType_t i = 0; i < tickCostBlockedTasks; i++) {
+            xTaskCreate(vSleepingTask, "Sleeping Task", mainGENERIC_STACK_SIZE,
+                        (void *)i, PRIORITY_KILLER, NULL);
+        }
+        xTaskCreate(vTickCostTask, "Tick Cost Task", mainGENERIC_STACK_SIZE,
+                    NULL, PRIORITY_WORKER, NULL);
+        vTaskStartScheduler();
+        return EXIT_SUCCESS;
+    }
+
+#if (listUSE_ORDERS == 1)
+    /* randomized check of the timing wheel */
+    if ((argc >= 2 && argc <= 4) && strcmp("wheelcheck", argv[1]) == 0) {
+        UBaseType_t rounds = WHEELCHECK_DEFAULT_ROUNDS;
+        uint64_t seed = 1;
+
+        if (argc >= 3) {
+            rounds = strtoul(argv[2], NULL, 10);
+        }
+        if (argc == 4) {
+            seed = strtoull(argv[3], NULL, 10);
+        }
+
+        UBaseType_t failures = checkTimingWheel(rounds, seed);
+        prints("Wheel check:            %lu rounds, %lu failures\n",
+               rounds, failures);
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+#endif
+
+    /* many tasksets in one process, or in one process per CPU */
+    BaseType_t sweep = argc >= 2 && strcmp("sweep", argv[1]) == 0;
+    if ((argc >= 3 && argc <= 4 + sweep) &&
+        (sweep || strcmp("batch", argv[1]) == 0)) {
+        UBaseType_t workers = 0;
+
+        if (sweep && argc >= 4) {
+            workers = strtoul(argv[3], NULL, 10);
+            if (workers == 0) {
+                printHelp(1);
+                return EXIT_FAILURE;
+            }
+        }
+        if (argc == 4 + sweep && !selectDelayedListOrder(argv[3 + sweep])) {
+            printHelp(5);
+            return EXIT_FAILURE;
+        }
+
+        batchMode = pdTRUE;
+        prints(RESULT_HEADER);
+        if (sweep) {
+            errorcode = runSweep(argv[2], workers) != 0;
+        }
+        else {
+            openResults(-1);
+            startTrace(-1);
+            errorcode = runBatch(argv[2]) != 0;
+            stopTrace();
+            closeResults();
+        }
+        return errorcode == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* text tasksets into a binary taskset file */
+    if (argc == 4 && strcmp("convert", argv[1]) == 0) {
+        errorcode = convertTasksets(argv[2], argv[3]);
+        if (errorcode == 3) {
+            printHelp(errorcode);
+        }
+        if (errorcode != 0) {
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    /* tasksets generated in memory */
+    if (argc >= 6 && argc <= 10 && argc != 8 &&
+        strcmp("generate", argv[1]) == 0) {
+        uint64_t seed = strtoull(argv[2], NULL, 10);
+        UBaseType_t count = strtoul(argv[3], NULL, 10);
+        UBaseType_t tasks = strtoul(argv[4], NULL, 10);
+        double utilization = strtod(argv[5], NULL);
+        UBaseType_t distribution = 2;
+        TickType_t minPeriod = GENERATOR_DEFAULT_MIN_PERIOD;
+        TickType_t maxPeriod = GENERATOR_DEFAULT_MAX_PERIOD;
+        TickType_t duration = GENERATOR_DEFAULT_DURATION;
+
+        if (argc >= 7) {
+            for (UBaseType_t i = 0; i < 2; i++) {
+                if (strcmp(periodDistributions[i], argv[6]) == 0) {
+                    distribution = i;
+                }
+            }
+        }
+        else {
+            distribution = 0;
+        }
+        if (argc >= 9) {
+            minPeriod = strtoul(argv[7], NULL, 10);
+            maxPeriod = strtoul(argv[8], NULL, 10);
+        }
+        if (argc == 10) {
+            duration = strtoul(argv[9], NULL, 10);
+        }
+
+        if (count == 0 || tasks == 0 || utilization <= 0.0 ||
+            distribution == 2 || minPeriod == 0 || maxPeriod < minPeriod ||
+            duration == 0) {
+            printHelp(6);
+            return EXIT_FAILURE;
+        }
+
+        batchMode = pdTRUE;
+        prints(RESULT_HEADER);
+        openResults(-1);
+        startTrace(-1);
+        runGenerated(seed, count, tasks, utilization, distribution, minPeriod,
+                     maxPeriod, duration);
+        stopTrace();
+        closeResults();
+        return EXIT_SUCCESS;
     }
 
     /* test number parameters */
-    if (argc == 3) {
+    if (argc == 3 || argc == 4) {
         /* test mode */
         if ((strcmp("0", argv[1]) == 0) ||
             (strcmp("1", argv[1]) == 0)) {
             /* test file exists */
             if (access(argv[2], F_OK) != -1) {
                 /* extract taskset */
-                UBaseType_t periodReads = 0;
-                FILE *input_file;
-                input_file = fopen(argv[2], "r");
-                while (!feof(input_file) &&
-                       periodReads <= tasksCount) {
-                    if (simulationId == ULONG_MAX) {
-                        fscanf(input_file, "%lu",
-                               &simulationId);
-                    }
-                    else {
-                        if (simulationDuration ==
-                            INT_MAX) {
-                            fscanf(input_file, "%u",
-                                   &simulationDuration);
-                        }
-                        else {
-                            if (tasksCount ==
-                                ULONG_MAX) {
-                                fscanf(input_file,
-                                       "%lu",
-                                       &tasksCount);
-                            }
-                            else {
-                                fscanf(input_file,
-                                       "%lu",
-                                       &tasksPeriods
-                                       [periodReads++]);
-                            }
-                        }
-                    }
-                }
-                fclose(input_file);
-                if (simulationId < ULONG_MAX &&
-                    simulationDuration < INT_MAX &&
-                    tasksCount < ULONG_MAX &&
-                    tasksCount == (periodReads - 1)) {
-                    runnable = pdTRUE;
-                }
-                else {
-                    errorcode = 4;
-                }
+                errorcode = loadTaskset(argv[2]);
+                runnable = errorcode == 0 ? pdTRUE : pdFALSE;
             }
             else {
                 errorcode = 3;
@@ -174,6 +1604,12 @@ int main(int argc, char *argv[])
         errorcode = 1;
     }
 
+    /* select ordering of the delayed tasks */
+    if (runnable && argc == 4 && !selectDelayedListOrder(argv[3])) {
+        runnable = pdFALSE;
+        errorcode = 5;
+    }
+
     if (runnable) {
         /* print simulation details */
 #ifdef TRACE_TASKS
@@ -186,12 +1622,21 @@ int main(int argc, char *argv[])
         else {
             prints("Run tasks:              no\n");
         }
-        prints("Number of tasks:        %d\n", tasksCount);
-        prints("Periods:                %u", tasksPeriods[0]);
+        prints("Delayed list order:     %s\n",
+               delayedListOrders[delayedListOrder]);
+        prints("Time:                   %s\n",
+               configUSE_VIRTUAL_TIME ? "virtual" : "real");
+        prints("Context switch:         %s\n",
+               portCONTEXT_SWITCH);
+        prints("Timing backend:         %s, %.0f MHz, %.1f ns overhead\n",
+               tbClockGetName(), tbClockGetFrequency() / 1e6,
+               tbClockGetOverheadNs());
+        prints("Number of tasks:        %lu\n", tasksCount);
+        prints("Periods:                %u", simulationTasks[0].period);
 
         /* print task periods */
         for (UBaseType_t i = 1; i < tasksCount; i++) {
-            prints("\t%d", tasksPeriods[i]);
+            prints("\t%u", simulationTasks[i].period);
             if ((i + 1) % PRINT_NUMBER_OF_PERIODS_PER_LINE == 0) {
                 prints("\n                ");
             }
@@ -199,22 +1644,30 @@ int main(int argc, char *argv[])
         prints("\n\n");
 #endif
 
-        /* create worker tasks */
-        for (UBaseType_t i = 0; i < tasksCount; i++) {
-            tasksJobs[i] = 0;
-            xTaskCreate(vDefaultTask, "Default Task",
-                        mainGENERIC_STACK_SIZE * 2, (void *)i,
-                        PRIORITY_WORKER, NULL);
-        }
-
-        /* create killer task */
-        xTaskCreate(vKillSystem, "Ending Task",
-                    mainGENERIC_STACK_SIZE * 2, NULL, PRIORITY_KILLER,
-                    NULL);
+        createSimulationTasks(pdTRUE);
+#ifdef TRACE_TASKS
+        prints("Busy loop:              %.1f iterations per us\n\n",
+               busyLoopsPerUs);
+#endif
 
         /* start scheduler */
         if (strcmp("1", argv[1]) == 0) {
+#ifdef TRACE_BUFFER
+            if (tbInit(TRACE_BUFFER_FILE) != 0) {
+                return EXIT_FAILURE;
+            }
+#endif
+            openResults(-1);
+            uint64_t start = tbClockMonotonic();
             vTaskStartScheduler();
+            writeResults(argv[2], (tbClockMonotonic() - start) / 1e9);
+            closeResults();
+#ifdef TRACE_BUFFER
+            /* print insertion times now that they can't disturb anything */
+            if (tbDeinit() >= 0) {
+                tbDecode(TRACE_BUFFER_FILE, stdout, TB_DEFAULT_LABEL);
+            }
+#endif
         }
 
         /* end program */
@@ -235,7 +1688,7 @@ __attribute__((unused)) void vMainQueueSendPassed(void)
 /* cppcheck-suppress unusedFunction */
 __attribute__((unused)) void vApplicationIdleHook(void)
 {
-#ifdef __GCC_POSIX__
+#if defined( __GCC_POSIX__ ) && ( configUSE_VIRTUAL_TIME == 0 )
     struct timespec xTimeToSleep, xTimeSlept;
     /* Makes the process more agreeable when using the Posix simulator. */
     xTimeToSleep.tv_sec = 1;